@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2022 Arm Limited. All rights reserved.
+ */
+
+#ifndef SENSOR_DRV_CONFIG_H__
+#define SENSOR_DRV_CONFIG_H__
+
+//-------- <<< Use Configuration Wizard in Context Menu >>> --------------------
+
+// <h>Sensor Interface Instances
+// <i>Each instance uses its own VSI peripheral, interrupt line and
+// <i>Python model script (arm_vsi<n>.py).
+
+//   <q>VSI 0
+#define SENSOR_VSI0_ENABLE      1
+
+//   <q>VSI 1
+#define SENSOR_VSI1_ENABLE      0
+
+//   <q>VSI 2
+#define SENSOR_VSI2_ENABLE      0
+
+//   <q>VSI 3
+#define SENSOR_VSI3_ENABLE      0
+
+//   <q>VSI 4
+#define SENSOR_VSI4_ENABLE      0
+
+//   <q>VSI 5
+#define SENSOR_VSI5_ENABLE      0
+
+//   <q>VSI 6
+#define SENSOR_VSI6_ENABLE      0
+
+//   <q>VSI 7
+#define SENSOR_VSI7_ENABLE      0
+
+// </h>
+
+// <e>Sample Ring Buffers
+// <i>VSI interrupt handler drains sensor FIFOs into per-sensor lock-free
+// <i>single-producer/single-consumer ring buffers in RAM. Read functions
+// <i>then access memory only (no peripheral register access). Scale settings
+// <i>are cached by Sensor_Initialize and Sensor_SetScale.
+#define SENSOR_RING_ENABLE      0
+
+//   <o>Ring buffer size (in 32-bit words) <8-65536>
+//   <i>Each sample occupies (1 + number of axes) words. Must be a power of 2.
+#define SENSOR_RING_SIZE        256
+
+// </e>
+
+//------------- <<< end of configuration section >>> ---------------------------
+
+#endif /* SENSOR_DRV_CONFIG_H__ */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022 Arm Limited. All rights reserved.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "sensor_convert.h"
+
+/* Use Helium (M-Profile Vector Extension with floating-point) when available */
+#if defined(__ARM_FEATURE_MVE) && ((__ARM_FEATURE_MVE & 2) != 0)
+#define SENSOR_CONVERT_MVE  1
+#include <arm_mve.h>
+#else
+#define SENSOR_CONVERT_MVE  0
+#endif
+
+
+void Sensor_ConvertData (const int32_t *src, float *dst, uint32_t num, int32_t scale) {
+  float k;
+
+  if ((src == NULL) || (dst == NULL)) {
+    return;
+  }
+
+  if (scale == 0) {
+    /* Invalid scale, data is defined as zero */
+    memset(dst, 0, num * sizeof(float));
+    return;
+  }
+
+  /* Single division per block */
+  k = 1.0f / (float)scale;
+
+#if (SENSOR_CONVERT_MVE != 0)
+  {
+    mve_pred16_t p;
+    int32x4_t    vi;
+    float32x4_t  vf;
+
+    while (num > 0U) {
+      /* Tail predicated processing of 4 entries */
+      p  = vctp32q(num);
+      vi = vldrwq_z_s32(src, p);
+      vf = vmulq_x_n_f32(vcvtq_x_f32_s32(vi, p), k, p);
+      vstrwq_p_f32(dst, vf, p);
+
+      src += 4;
+      dst += 4;
+      num  = (num > 4U) ? (num - 4U) : 0U;
+    }
+  }
+#else
+  {
+    uint32_t i;
+
+    /* Simple loop, suitable for compiler auto-vectorization */
+    for (i = 0U; i < num; i++) {
+      dst[i] = (float)src[i] * k;
+    }
+  }
+#endif
+}
+
+
+void Sensor_ConvertAxes (const int32_t *src, float *x, float *y, float *z, uint32_t num, int32_t scale) {
+  float k;
+
+  if ((src == NULL) || (x == NULL) || (y == NULL) || (z == NULL)) {
+    return;
+  }
+
+  if (scale == 0) {
+    /* Invalid scale, data is defined as zero */
+    memset(x, 0, num * sizeof(float));
+    memset(y, 0, num * sizeof(float));
+    memset(z, 0, num * sizeof(float));
+    return;
+  }
+
+  /* Single division per block */
+  k = 1.0f / (float)scale;
+
+#if (SENSOR_CONVERT_MVE != 0)
+  {
+    static const uint32_t offs[4] = { 0U, 3U, 6U, 9U };
+    mve_pred16_t p;
+    uint32x4_t   vo;
+    int32x4_t    vi;
+    float32x4_t  vf;
+
+    /* Gather offsets of 4 consecutive samples (in 32-bit words) */
+    vo = vld1q_u32(offs);
+
+    while (num > 0U) {
+      /* Tail predicated processing of 4 samples (12 entries) */
+      p  = vctp32q(num);
+
+      vi = vldrwq_gather_shifted_offset_z_s32(src,      vo, p);
+      vf = vmulq_x_n_f32(vcvtq_x_f32_s32(vi, p), k, p);
+      vstrwq_p_f32(x, vf, p);
+
+      vi = vldrwq_gather_shifted_offset_z_s32(src + 1U, vo, p);
+      vf = vmulq_x_n_f32(vcvtq_x_f32_s32(vi, p), k, p);
+      vstrwq_p_f32(y, vf, p);
+
+      vi = vldrwq_gather_shifted_offset_z_s32(src + 2U, vo, p);
+      vf = vmulq_x_n_f32(vcvtq_x_f32_s32(vi, p), k, p);
+      vstrwq_p_f32(z, vf, p);
+
+      src += 12;
+      x   += 4;
+      y   += 4;
+      z   += 4;
+      num  = (num > 4U) ? (num - 4U) : 0U;
+    }
+  }
+#else
+  {
+    uint32_t i;
+
+    for (i = 0U; i < num; i++) {
+      x[i] = (float)src[(3U * i) + 0U] * k;
+      y[i] = (float)src[(3U * i) + 1U] * k;
+      z[i] = (float)src[(3U * i) + 2U] * k;
+    }
+  }
+#endif
+}
@@ -3,9 +3,12 @@
  */
 
 #include <stddef.h>
+#include <string.h>
 #include "sensor_drv.h"
+#include "sensor_convert.h"
 #include "sensor_vsi.h"
 #include "arm_vsi.h"
+#include "sensor_drv_config.h"
 
 #include "RTE_Components.h"
 #include CMSIS_device_header
@@ -25,35 +28,221 @@
   See: https://sst.semiconductor-digest.com/2010/11/introduction-to-mems-gyroscopes/
 */
 
-#define VSI               ARM_VSI0              /* VSI instance          */
-#define VSI_IRQn          ARM_VSI0_IRQn         /* VSI interrupt number  */
-#define VSI_Handler       ARM_VSI0_Handler      /* VSI interrupt handler */
-
-#define STATUS            Regs[0]
-#define INTERVAL          Regs[1]
-#define SELECT            Regs[2]
-#define ENABLE            Regs[3]
-#define SCALE             Regs[4]
-#define ODR               Regs[5]
-#define FIFO_CNT          Regs[6]
-#define FIFO              Regs[7]
+/* Global registers */
+#define STATUS            Regs[SENSOR_REG_STATUS]
+#define INTERVAL          Regs[SENSOR_REG_INTERVAL]
+#define STREAM            Regs[SENSOR_REG_STREAM]
+#define LATENCY           Regs[SENSOR_REG_LATENCY]
+
+/* Sensor register banks */
+#define ENABLE(type)      Regs[SENSOR_REG_BANK(type) + SENSOR_REG_ENABLE]
+#define SCALE(type)       Regs[SENSOR_REG_BANK(type) + SENSOR_REG_SCALE]
+#define ODR(type)         Regs[SENSOR_REG_BANK(type) + SENSOR_REG_ODR]
+#define FIFO_CNT(type)    Regs[SENSOR_REG_BANK(type) + SENSOR_REG_FIFO_CNT]
+#define FIFO(type)        Regs[SENSOR_REG_BANK(type) + SENSOR_REG_FIFO]
+#define FIFO_TS(type)     Regs[SENSOR_REG_BANK(type) + SENSOR_REG_FIFO_TS]
+#define WATERMARK(type)   Regs[SENSOR_REG_BANK(type) + SENSOR_REG_WATERMARK]
+#define OVERRUN(type)     Regs[SENSOR_REG_BANK(type) + SENSOR_REG_OVERRUN]
 
 /* Number of sensors implemented using VSI peripheral */
 #define SENSOR_COUNT      6
 
-/* Event Callback */
-static Sensor_Event_t CB_Event = NULL;
+/* Number of FIFO entries converted at once by bulk read functions
+   (multiple of 3 to hold whole motion sensor samples) */
+#define READ_BLOCK        24U
+
+/* DMA block stream */
+typedef struct {
+  uint32_t          Active;             /* Stream active flag                  */
+  uint32_t          Type;               /* Streamed sensor type                */
+  uint8_t          *Buf;                /* Ring buffer memory                  */
+  uint32_t          BlockSize;          /* Block size in bytes                 */
+  uint32_t          BlockNum;           /* Number of blocks in ring buffer     */
+  uint32_t          Base;               /* Timer count at stream start         */
+  uint32_t          RdCnt;              /* Timer count of next block to read   */
+} STREAM_t;
+
+#if (SENSOR_RING_ENABLE != 0)
+#if ((SENSOR_RING_SIZE & (SENSOR_RING_SIZE - 1)) != 0)
+#error "SENSOR_RING_SIZE must be a power of 2"
+#endif
+
+/* Single-producer (VSI interrupt handler) single-consumer ring buffer.
+   Each sample is stored as timestamp followed by its FIFO entries. */
+typedef struct {
+  volatile uint32_t Head;               /* Words written (interrupt handler)   */
+  volatile uint32_t Tail;               /* Words read (consumer thread)        */
+  int32_t           Scale;              /* Scale setting (register copy)       */
+  uint32_t          Buf[SENSOR_RING_SIZE];
+} RING_t;
+#endif
+
+/* Sensor interface instance resources */
+typedef struct Sensor_Resources_s {
+  ARM_VSI_Type     *VSI;                /* VSI peripheral                      */
+  uint32_t          IRQn;               /* VSI interrupt number                */
+  Sensor_Event_t    CB_Event;           /* Event callback                      */
+  volatile uint32_t TimerArmed;         /* One-shot deadline timer armed       */
+  STREAM_t          Stream;             /* DMA block stream                    */
+#if (SENSOR_RING_ENABLE != 0)
+  RING_t            Ring[SENSOR_COUNT]; /* Sample ring buffers                 */
+#endif
+} SENSOR_RESOURCES;
+
+static uint32_t IsTypeValid (uint32_t type) {
+
+  if ((type == SENSOR_TYPE_TEMP) || (type == SENSOR_TYPE_HUM)  || (type == SENSOR_TYPE_PRESS) ||
+      (type == SENSOR_TYPE_ACC)  || (type == SENSOR_TYPE_GYRO) || (type == SENSOR_TYPE_MAG))  {
+    return (1U);
+  } else {
+    /* None of the above */
+    return (0U);
+  }
+}
+
+static uint32_t IsTypeEnv (uint32_t type) {
+
+  if ((type == SENSOR_TYPE_TEMP) || (type == SENSOR_TYPE_HUM)  || (type == SENSOR_TYPE_PRESS)) {
+    return (1U);
+  } else {
+    /* Not environmental sensor */
+    return (0U);
+  }
+}
+
+static uint32_t GetEntries (uint32_t type) {
+
+  if (IsTypeEnv(type) != 0U) {
+    return (SENSOR_ENTRIES_ENV);
+  } else {
+    /* Motion sensor sample consists of 3 FIFO entries */
+    return (SENSOR_ENTRIES_MOTION);
+  }
+}
+
+#if (SENSOR_RING_ENABLE != 0)
+/* Move samples from sensor FIFO into ring buffer (producer) */
+static void RingFill (SENSOR_RESOURCES *h, uint32_t type) {
+  RING_t  *r = &h->Ring[type];
+  uint32_t entries;
+  uint32_t head;
+  uint32_t num;
+  uint32_t n;
+
+  entries = GetEntries(type);
+  head    = r->Head;
+
+  num = h->VSI->FIFO_CNT(type) / entries;
+
+  /* Copy whole samples while there is space in ring buffer */
+  while ((num != 0U) && ((SENSOR_RING_SIZE - (head - r->Tail)) >= (entries + 1U))) {
+    r->Buf[head++ & (SENSOR_RING_SIZE - 1U)] = h->VSI->FIFO_TS(type);
+
+    for (n = 0U; n < entries; n++) {
+      r->Buf[head++ & (SENSOR_RING_SIZE - 1U)] = h->VSI->FIFO(type);
+    }
+    num--;
+  }
+
+  /* Publish samples after they are written */
+  __DMB();
+  r->Head = head;
+}
+
+/* Empty ring buffers and load scale settings (interrupt disabled) */
+static void RingReset (SENSOR_RESOURCES *h) {
+  uint32_t id;
+
+  for (id = 0U; id < SENSOR_COUNT; id++) {
+    h->Ring[id].Head  = 0U;
+    h->Ring[id].Tail  = 0U;
+    h->Ring[id].Scale = (int32_t)h->VSI->SCALE(id);
+  }
+}
+#endif
+
+/* Arm peripheral timer (one-shot) with interval to the next deadline */
+static void TimerArm (SENSOR_RESOURCES *h, uint32_t interval) {
+
+  if (interval == 0U) {
+    /* No enabled sensor to service */
+    h->VSI->Timer.Control = 0U;
+    h->TimerArmed = 0U;
+  } else {
+    h->VSI->Timer.Interval = interval;
+    h->VSI->Timer.Control  = ARM_VSI_Timer_Trig_IRQ_Msk |
+                             ARM_VSI_Timer_Run_Msk;
+    h->TimerArmed = 1U;
+  }
+}
+
+/* Arm peripheral timer (one-shot) for the next deadline of enabled sensors */
+static void TimerStart (SENSOR_RESOURCES *h) {
+  TimerArm(h, h->VSI->INTERVAL);
+}
+
+/* Re-arm peripheral timer when sensor settings moved the next deadline
+   earlier. INTERVAL is counted from the last timer event, but re-arming
+   restarts the timer from now: the new deadline fires late by the time
+   already spent in the current interval (not visible to the driver, the
+   timer counts overflows only, nor to the model, whose virtual time moves
+   by the armed interval at each timer event). An armed timer with an
+   interval not longer than INTERVAL is therefore kept, not restarted.
+   Timer state is shared with the interrupt handler, the VSI interrupt is
+   masked while it is updated. */
+static void TimerUpdate (SENSOR_RESOURCES *h) {
+  uint32_t irq_bit;
+  uint32_t irq_en;
+  uint32_t interval;
+
+  irq_bit = 1UL << (((uint32_t)h->IRQn) & 0x1FUL);
+  irq_en  = NVIC->ISER[(((uint32_t)h->IRQn) >> 5UL)] & irq_bit;
+
+  NVIC->ICER[(((uint32_t)h->IRQn) >> 5UL)] = irq_bit;
+  __DSB();
+  __ISB();
+
+  if (h->Stream.Active == 0U) {
+    interval = h->VSI->INTERVAL;
+
+    if ((h->TimerArmed == 0U) || ((interval != 0U) && (interval < h->VSI->Timer.Interval))) {
+      TimerArm(h, interval);
+    }
+  }
+  /* else: timer runs at stream block period */
+
+  if (irq_en != 0U) {
+    NVIC->ISER[(((uint32_t)h->IRQn) >> 5UL)] = irq_bit;
+  }
+}
 
 /* VSI interrupt handler */
-void VSI_Handler (void) {
+static void VSI_Handler (SENSOR_RESOURCES *h) {
   uint32_t status;
   uint32_t event;
 
-  VSI->IRQ.Clear = 1U;
+  h->VSI->IRQ.Clear = 1U;
   __DSB();
   __ISB();
 
-  status = VSI->STATUS;
+  status = h->VSI->STATUS;
+
+#if (SENSOR_RING_ENABLE != 0)
+  {
+    uint32_t id;
+
+    for (id = 0U; id < SENSOR_COUNT; id++) {
+      if ((status & (1UL << id)) != 0U) {
+        RingFill(h, id);
+      }
+    }
+  }
+#endif
+
+  if (h->Stream.Active == 0U) {
+    /* One-shot timer expired, re-arm it for the next deadline */
+    TimerStart(h);
+  }
 
   event = 0U;
 
@@ -76,149 +265,345 @@ void VSI_Handler (void) {
     event |= SENSOR_EVENT_MAG_DATA_AVAILABLE;
   }
 
-  if ((CB_Event != NULL) && (event != 0U)) {
-    CB_Event(event);
+  if (status & SENSOR_STATUS_OVERRUN_TEMP) {
+    event |= SENSOR_EVENT_TEMP_OVERRUN;
+  }
+  if (status & SENSOR_STATUS_OVERRUN_HUM) {
+    event |= SENSOR_EVENT_HUM_OVERRUN;
+  }
+  if (status & SENSOR_STATUS_OVERRUN_PRESS) {
+    event |= SENSOR_EVENT_PRESS_OVERRUN;
+  }
+  if (status & SENSOR_STATUS_OVERRUN_ACC) {
+    event |= SENSOR_EVENT_ACC_OVERRUN;
+  }
+  if (status & SENSOR_STATUS_OVERRUN_GYRO) {
+    event |= SENSOR_EVENT_GYRO_OVERRUN;
+  }
+  if (status & SENSOR_STATUS_OVERRUN_MAG) {
+    event |= SENSOR_EVENT_MAG_OVERRUN;
+  }
+
+  if (h->Stream.Active != 0U) {
+    /* Timer event transferred next block into ring buffer */
+    event |= SENSOR_EVENT_BLOCK_AVAILABLE;
+  }
+
+  if ((h->CB_Event != NULL) && (event != 0U)) {
+    h->CB_Event(h, event);
   }
 }
 
-static uint32_t IsTypeValid (uint32_t type) {
+/* Instance resources and interrupt handler of VSI peripheral n */
+#define SENSOR_VSI_INSTANCE(n)                                                      \
+  static SENSOR_RESOURCES Sensor_VSI##n = {                                        \
+    .VSI  = ARM_VSI##n,                                                             \
+    .IRQn = ARM_VSI##n##_IRQn                                                       \
+  };                                                                                \
+  void ARM_VSI##n##_Handler (void);                                                 \
+  void ARM_VSI##n##_Handler (void) {                                                \
+    VSI_Handler(&Sensor_VSI##n);                                                    \
+  }
 
-  if ((type == SENSOR_TYPE_TEMP) || (type == SENSOR_TYPE_HUM)  || (type == SENSOR_TYPE_PRESS) ||
-      (type == SENSOR_TYPE_ACC)  || (type == SENSOR_TYPE_GYRO) || (type == SENSOR_TYPE_MAG))  {
-    return (1U);
-  } else {
-    /* None of the above */
-    return (0U);
+#if (SENSOR_VSI0_ENABLE != 0)
+SENSOR_VSI_INSTANCE(0)
+#endif
+#if (SENSOR_VSI1_ENABLE != 0)
+SENSOR_VSI_INSTANCE(1)
+#endif
+#if (SENSOR_VSI2_ENABLE != 0)
+SENSOR_VSI_INSTANCE(2)
+#endif
+#if (SENSOR_VSI3_ENABLE != 0)
+SENSOR_VSI_INSTANCE(3)
+#endif
+#if (SENSOR_VSI4_ENABLE != 0)
+SENSOR_VSI_INSTANCE(4)
+#endif
+#if (SENSOR_VSI5_ENABLE != 0)
+SENSOR_VSI_INSTANCE(5)
+#endif
+#if (SENSOR_VSI6_ENABLE != 0)
+SENSOR_VSI_INSTANCE(6)
+#endif
+#if (SENSOR_VSI7_ENABLE != 0)
+SENSOR_VSI_INSTANCE(7)
+#endif
+
+static uint32_t GetFIFOCount (SENSOR_RESOURCES *h, uint32_t type, uint32_t max) {
+  uint32_t num;
+
+#if (SENSOR_RING_ENABLE != 0)
+  /* Number of samples available in ring buffer */
+  num = (h->Ring[type].Head - h->Ring[type].Tail) / (GetEntries(type) + 1U);
+  num *= GetEntries(type);
+#else
+  /* Read number of samples available in FIFO */
+  num = h->VSI->FIFO_CNT(type);
+#endif
+
+  if (num > max) {
+    num = max;
   }
+
+  /* Read whole samples only */
+  num -= num % GetEntries(type);
+
+  return (num);
 }
 
-static uint32_t IsTypeEnv (uint32_t type) {
+/* Get scale setting (cached with ring buffers, read functions then access
+   RAM only) */
+static int32_t GetScale (SENSOR_RESOURCES *h, uint32_t type) {
+#if (SENSOR_RING_ENABLE != 0)
+  return (h->Ring[type].Scale);
+#else
+  return ((int32_t)h->VSI->SCALE(type));
+#endif
+}
 
-  if ((type == SENSOR_TYPE_TEMP) || (type == SENSOR_TYPE_HUM)  || (type == SENSOR_TYPE_PRESS)) {
-    return (1U);
-  } else {
-    /* Not environmental sensor */
+/* Read one sample (optional timestamp and FIFO entries) */
+static void ReadSample (SENSOR_RESOURCES *h, uint32_t type, uint32_t entries, uint32_t *ts, int32_t *val) {
+  uint32_t n;
+#if (SENSOR_RING_ENABLE != 0)
+  RING_t  *r = &h->Ring[type];
+  uint32_t tail;
+
+  /* Read samples only after they are published */
+  __DMB();
+  tail = r->Tail;
+
+  if (ts != NULL) {
+    *ts = r->Buf[tail & (SENSOR_RING_SIZE - 1U)];
+  }
+  tail++;
+
+  for (n = 0U; n < entries; n++) {
+    val[n] = (int32_t)r->Buf[tail++ & (SENSOR_RING_SIZE - 1U)];
+  }
+
+  /* Release space after sample is read */
+  __DMB();
+  r->Tail = tail;
+#else
+  if (ts != NULL) {
+    /* Read timestamp of the sample at FIFO head */
+    *ts = h->VSI->FIFO_TS(type);
+  }
+
+  for (n = 0U; n < entries; n++) {
+    /* Read FIFO */
+    val[n] = (int32_t)h->VSI->FIFO(type);
+  }
+#endif
+}
+
+/* Fixed-point conversion: Q31 = raw / (scale * range) */
+typedef struct {
+  int64_t Lim;                          /* Full scale range in FIFO counts     */
+  int64_t Mult;                         /* 2^62 / Lim                          */
+} QCONV_t;
+
+/* Returns 0 when scale * range is not in 1..2^62 (Mult would be 0) */
+static uint32_t QConvInit (QCONV_t *q, int32_t scale, uint32_t range) {
+  uint64_t lim;
+
+  if (scale <= 0) {
     return (0U);
   }
+
+  /* Product of 31-bit and 32-bit values does not overflow 64 bits */
+  lim = (uint64_t)scale * (uint64_t)range;
+  if ((lim == 0U) || (lim > (1ULL << 62))) {
+    return (0U);
+  }
+
+  /* Single division per batch */
+  q->Lim  = (int64_t)lim;
+  q->Mult = (int64_t)((1ULL << 62) / lim);
+
+  return (1U);
 }
 
+static int32_t QConv (const QCONV_t *q, int32_t raw) {
+  int64_t val = raw;
 
-int32_t Sensor_Initialize (Sensor_Event_t cb_event) {
+  /* Saturate values outside of full scale range */
+  if (val >= q->Lim) {
+    return (INT32_MAX);
+  }
+  if (val <= -q->Lim) {
+    return (INT32_MIN);
+  }
+
+  /* |val * Mult| < 2^62 */
+  return ((int32_t)((val * q->Mult) >> 31));
+}
+
+
+/* Sensor interface instances (NULL when not enabled) */
+static SENSOR_RESOURCES * const Sensor_Instance[SENSOR_INSTANCE_COUNT] = {
+#if (SENSOR_VSI0_ENABLE != 0)
+  [0] = &Sensor_VSI0,
+#endif
+#if (SENSOR_VSI1_ENABLE != 0)
+  [1] = &Sensor_VSI1,
+#endif
+#if (SENSOR_VSI2_ENABLE != 0)
+  [2] = &Sensor_VSI2,
+#endif
+#if (SENSOR_VSI3_ENABLE != 0)
+  [3] = &Sensor_VSI3,
+#endif
+#if (SENSOR_VSI4_ENABLE != 0)
+  [4] = &Sensor_VSI4,
+#endif
+#if (SENSOR_VSI5_ENABLE != 0)
+  [5] = &Sensor_VSI5,
+#endif
+#if (SENSOR_VSI6_ENABLE != 0)
+  [6] = &Sensor_VSI6,
+#endif
+#if (SENSOR_VSI7_ENABLE != 0)
+  [7] = &Sensor_VSI7,
+#endif
+};
+
+Sensor_Handle_t Sensor_GetHandle (uint32_t instance) {
+
+  if (instance >= SENSOR_INSTANCE_COUNT) {
+    return (NULL);
+  }
+
+  return (Sensor_Instance[instance]);
+}
+
+int32_t Sensor_Initialize (Sensor_Handle_t h, Sensor_Event_t cb_event) {
   uint32_t id;
 
-  CB_Event = cb_event;
+  if (h == NULL) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  h->CB_Event = cb_event;
 
   /* Initialize VSI peripheral */
-  VSI->Timer.Control = 0U;
-  VSI->DMA.Control   = 0U;
-  VSI->IRQ.Clear     = 0x00000001U;
-  VSI->IRQ.Enable    = 0x00000001U;
+  h->VSI->Timer.Control = 0U;
+  h->TimerArmed         = 0U;
+  h->VSI->DMA.Control   = 0U;
+  h->VSI->IRQ.Clear     = 0x00000001U;
+  h->VSI->IRQ.Enable    = 0x00000001U;
 
   /* Disable sensors */
   for (id = 0U; id < SENSOR_COUNT; id++) {
-    VSI->SELECT = id;
-    VSI->ENABLE = 0U;
+    h->VSI->ENABLE(id) = 0U;
   }
 
+#if (SENSOR_RING_ENABLE != 0)
+  /* Discard samples of previous session */
+  RingReset(h);
+#endif
+
   /* Enable VSI interrupts */
-  NVIC->ISER[(((uint32_t)VSI_IRQn) >> 5UL)] = (uint32_t)(1UL << (((uint32_t)VSI_IRQn) & 0x1FUL));
-  // NVIC_EnableIRQ(VSI_IRQn);
+  NVIC->ISER[(((uint32_t)h->IRQn) >> 5UL)] = (uint32_t)(1UL << (((uint32_t)h->IRQn) & 0x1FUL));
+  // NVIC_EnableIRQ(h->IRQn);
   __DSB();
   __ISB();
 
   return SENSOR_OK;
 }
 
-int32_t Sensor_Uninitialize (void) {
+int32_t Sensor_Uninitialize (Sensor_Handle_t h) {
   uint32_t id;
 
+  if (h == NULL) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
   /* Disable VSI interrupts */
-  NVIC->ICER[(((uint32_t)VSI_IRQn)  >> 5UL)] = (uint32_t)(1UL << (((uint32_t)VSI_IRQn)  & 0x1FUL));
-  // NVIC_DisableIRQ(VSI_IRQn);
+  NVIC->ICER[(((uint32_t)h->IRQn)  >> 5UL)] = (uint32_t)(1UL << (((uint32_t)h->IRQn)  & 0x1FUL));
+  // NVIC_DisableIRQ(h->IRQn);
   __DSB();
   __ISB();
 
   /* De-initialize VSI output */
-  VSI->Timer.Control = 0U;
-  VSI->DMA.Control   = 0U;
-  VSI->IRQ.Clear     = 0x00000001U;
-  VSI->IRQ.Enable    = 0x00000000U;
+  h->VSI->Timer.Control = 0U;
+  h->TimerArmed         = 0U;
+  h->VSI->DMA.Control   = 0U;
+  h->VSI->IRQ.Clear     = 0x00000001U;
+  h->VSI->IRQ.Enable    = 0x00000000U;
   
   /* Disable sensors */
   for (id = 0U; id < SENSOR_COUNT; id++) {
-    VSI->SELECT = id;
-    VSI->ENABLE = 0U;
+    h->VSI->ENABLE(id) = 0U;
   }
 
-  CB_Event = NULL;
+  if (h->Stream.Active != 0U) {
+    h->VSI->STREAM = 0U;
+    h->Stream.Active = 0U;
+  }
+
+#if (SENSOR_RING_ENABLE != 0)
+  RingReset(h);
+#endif
+
+  h->CB_Event = NULL;
 
   return SENSOR_OK;
 }
 
-int32_t Sensor_Enable (uint32_t type) {
+int32_t Sensor_Enable (Sensor_Handle_t h, uint32_t type) {
   uint32_t ctrl;
-  uint32_t div;
 
-  if (IsTypeValid(type) == 0U) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
   /* Enable sensor */
-  VSI->SELECT = type;
-  VSI->ENABLE = 1U;
-
-  /* Re-evaluate peripheral clock divider */
-  div = VSI->INTERVAL;
+  h->VSI->ENABLE(type) = 1U;
 
-  if (VSI->Timer.Interval != div) {
-    /* Re-configure peripheral timer (clock) */
-    VSI->Timer.Interval = div;
-    VSI->Timer.Control = ARM_VSI_Timer_Trig_IRQ_Msk |
-                         ARM_VSI_Timer_Periodic_Msk |
-                         ARM_VSI_Timer_Run_Msk;
-  }
+  /* Start timer for the first deadline of the sensor */
+  TimerUpdate(h);
 
   return SENSOR_OK;
 }
 
-int32_t Sensor_Disable (uint32_t type) {
+int32_t Sensor_Disable (Sensor_Handle_t h, uint32_t type) {
   uint32_t ctrl;
 
-  if (IsTypeValid(type) == 0U) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
   /* Disable sensor */
-  VSI->SELECT = type;
-  VSI->ENABLE = 0U;
+  h->VSI->ENABLE(type) = 0U;
 
   return SENSOR_OK;
 }
 
 
-int32_t Sensor_MotionReadData (uint32_t type, float *x, float *y, float *z) {
+int32_t Sensor_MotionReadData (Sensor_Handle_t h, uint32_t type, float *x, float *y, float *z) {
   uint32_t num;
-  uint32_t scale;
-  int32_t axes[3];
+  float    k;
+  int32_t  axes[3];
 
-  /* Select requested sensor */
-  VSI->SELECT = type;
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (IsTypeEnv(type) != 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
 
   /* Read current scale setting */
-  scale = VSI->SCALE;
+  k = 1.0f / (float)GetScale(h, type);
 
   /* Read number of samples available in FIFO */
-  num = VSI->FIFO_CNT;
+  num = GetFIFOCount(h, type, UINT32_MAX);
 
   if (num > 0U) {
     /* Read FIFO */
-    axes[0] = VSI->FIFO;
-    axes[1] = VSI->FIFO;
-    axes[2] = VSI->FIFO;
+    ReadSample(h, type, 3U, NULL, axes);
 
-    *x = (float)axes[0] / scale;
-    *y = (float)axes[1] / scale;
-    *z = (float)axes[2] / scale;
+    *x = (float)axes[0] * k;
+    *y = (float)axes[1] * k;
+    *z = (float)axes[2] * k;
 
     /* Decrease number of samples available */
     num -= 3U;
@@ -229,25 +614,26 @@ int32_t Sensor_MotionReadData (uint32_t type, float *x, float *y, float *z) {
 }
 
 
-int32_t Sensor_EnvReadData (uint32_t type, float *data) {
+int32_t Sensor_EnvReadData (Sensor_Handle_t h, uint32_t type, float *data) {
   uint32_t num;
-  uint32_t scale;
-  int32_t val;
+  float    k;
+  int32_t  val;
 
-  /* Select requested sensor */
-  VSI->SELECT = type;
+  if ((h == NULL) || (IsTypeEnv(type) == 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
 
   /* Read current scale setting */
-  scale = VSI->SCALE;
+  k = 1.0f / (float)GetScale(h, type);
 
   /* Read number of samples available in FIFO */
-  num = VSI->FIFO_CNT;
+  num = GetFIFOCount(h, type, UINT32_MAX);
 
   if (num > 0U) {
     /* Read FIFO */
-    val = VSI->FIFO;
+    ReadSample(h, type, 1U, NULL, &val);
 
-    *data = (float)val / scale;
+    *data = (float)val * k;
 
     /* Decrement number of samples available */
     num--;
@@ -258,100 +644,441 @@ int32_t Sensor_EnvReadData (uint32_t type, float *data) {
 }
 
 
-int32_t Sensor_QueryInterval (uint32_t type, uint32_t interval[], uint32_t len) {
+int32_t Sensor_ReadSamples (Sensor_Handle_t h, uint32_t type, float *buf, uint32_t max) {
+  uint32_t num;
+  uint32_t entries;
+  uint32_t i, n, cnt;
+  int32_t  scale;
+  int32_t  raw[READ_BLOCK];
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (buf == NULL)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  entries = GetEntries(type);
+
+  /* Read current scale setting */
+  scale = GetScale(h, type);
+  if (scale == 0) {
+    /* Samples cannot be converted, leave them in FIFO */
+    return (SENSOR_ERROR);
+  }
+
+  /* Read number of samples available in FIFO */
+  num = GetFIFOCount(h, type, max);
+
+  for (i = 0U; i < num; i += cnt) {
+    cnt = num - i;
+    if (cnt > READ_BLOCK) {
+      cnt = READ_BLOCK;
+    }
+
+    for (n = 0U; n < cnt; n += entries) {
+      ReadSample(h, type, entries, NULL, &raw[n]);
+    }
+
+    /* Convert block of raw FIFO entries */
+    Sensor_ConvertData(raw, &buf[i], cnt, scale);
+  }
+
+  /* Return number of data items read */
+  return ((int32_t)num);
+}
+
+
+int32_t Sensor_ReadSamplesRaw (Sensor_Handle_t h, uint32_t type, int32_t *buf, uint32_t max, int32_t *scale) {
+  uint32_t num;
+  uint32_t entries;
+  uint32_t i;
 
-  if ((IsTypeValid(type) == 0U) || (interval == NULL) || (len == 0U)) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (buf == NULL)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
-  /* Select sensor */
-  VSI->SELECT = type;
+  entries = GetEntries(type);
+
+  if (scale != NULL) {
+    /* Read current scale setting */
+    *scale = GetScale(h, type);
+  }
+
+  /* Read number of samples available in FIFO */
+  num = GetFIFOCount(h, type, max);
+
+  for (i = 0U; i < num; i += entries) {
+    ReadSample(h, type, entries, NULL, &buf[i]);
+  }
+
+  /* Return number of FIFO entries read */
+  return ((int32_t)num);
+}
+
+
+int32_t Sensor_ReadSamplesQ31 (Sensor_Handle_t h, uint32_t type, int32_t *buf, uint32_t max, uint32_t range) {
+  QCONV_t  q;
+  uint32_t num;
+  uint32_t entries;
+  uint32_t i, n;
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (buf == NULL) || (range == 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  if (QConvInit(&q, GetScale(h, type), range) == 0U) {
+    return (SENSOR_ERROR);
+  }
+
+  entries = GetEntries(type);
+
+  /* Read number of samples available in FIFO */
+  num = GetFIFOCount(h, type, max);
+
+  for (i = 0U; i < num; i += entries) {
+    ReadSample(h, type, entries, NULL, &buf[i]);
+
+    for (n = 0U; n < entries; n++) {
+      buf[i + n] = QConv(&q, buf[i + n]);
+    }
+  }
+
+  /* Return number of data items read */
+  return ((int32_t)num);
+}
+
+
+int32_t Sensor_ReadSamplesQ15 (Sensor_Handle_t h, uint32_t type, int16_t *buf, uint32_t max, uint32_t range) {
+  QCONV_t  q;
+  uint32_t num;
+  uint32_t entries;
+  uint32_t i, n;
+  int32_t  val[3];
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (buf == NULL) || (range == 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  if (QConvInit(&q, GetScale(h, type), range) == 0U) {
+    return (SENSOR_ERROR);
+  }
+
+  entries = GetEntries(type);
+
+  /* Read number of samples available in FIFO */
+  num = GetFIFOCount(h, type, max);
+
+  for (i = 0U; i < num; i += entries) {
+    ReadSample(h, type, entries, NULL, val);
+
+    for (n = 0U; n < entries; n++) {
+      buf[i + n] = (int16_t)(QConv(&q, val[n]) >> 16);
+    }
+  }
+
+  /* Return number of data items read */
+  return ((int32_t)num);
+}
+
+
+int32_t Sensor_ReadSamplesTs (Sensor_Handle_t h, uint32_t type, uint32_t *ts, float *buf, uint32_t max) {
+  uint32_t num;
+  uint32_t entries;
+  uint32_t i, n, cnt;
+  int32_t  scale;
+  int32_t  raw[READ_BLOCK];
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (ts == NULL) || (buf == NULL)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  entries = GetEntries(type);
+
+  /* Read current scale setting */
+  scale = GetScale(h, type);
+  if (scale == 0) {
+    /* Samples cannot be converted, leave them in FIFO */
+    return (SENSOR_ERROR);
+  }
+
+  /* Read number of samples available in FIFO */
+  num = GetFIFOCount(h, type, max);
+
+  for (i = 0U; i < num; i += cnt) {
+    cnt = num - i;
+    if (cnt > READ_BLOCK) {
+      cnt = READ_BLOCK;
+    }
+
+    for (n = 0U; n < cnt; n += entries) {
+      ReadSample(h, type, entries, &ts[(i + n) / entries], &raw[n]);
+    }
+
+    /* Convert block of raw FIFO entries */
+    Sensor_ConvertData(raw, &buf[i], cnt, scale);
+  }
+
+  /* Return number of data items read */
+  return ((int32_t)num);
+}
+
+
+int32_t Sensor_QueryInterval (Sensor_Handle_t h, uint32_t type, uint32_t interval[], uint32_t len) {
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (interval == NULL) || (len == 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
 
   /* This VSI driver implements single sampling interval */
-  interval[0] = VSI->ODR;
+  interval[0] = h->VSI->ODR(type);
 
   return (1U);
 }
 
 
-uint32_t Sensor_GetInterval (uint32_t type) {
+uint32_t Sensor_GetInterval (Sensor_Handle_t h, uint32_t type) {
   uint32_t odr;
 
-  if (IsTypeValid(type) == 0U) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
-  /* Select sensor */
-  VSI->SELECT = type;
-
   /* Retrieve current sampling interval */
-  odr = VSI->ODR;
+  odr = h->VSI->ODR(type);
 
   return (odr);
 }
 
 
-int32_t Sensor_SetInterval (uint32_t type, uint32_t interval) {
+int32_t Sensor_SetInterval (Sensor_Handle_t h, uint32_t type, uint32_t interval) {
   int32_t scale;
 
-  if (IsTypeValid(type) == 0U) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
-  /* Select sensor */
-  VSI->SELECT = type;
-
   /* Set sampling interval */
-  VSI->ODR = interval;
+  h->VSI->ODR(type) = interval;
+
+  TimerUpdate(h);
 
   return (SENSOR_OK);
 }
 
-int32_t Sensor_QueryScale (uint32_t type, int32_t data[], uint32_t len) {
+int32_t Sensor_QueryScale (Sensor_Handle_t h, uint32_t type, int32_t data[], uint32_t len) {
 
-  if ((IsTypeValid(type) == 0U) || (data == NULL) || (len == 0U)) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (data == NULL) || (len == 0U)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
-  /* Select sensor */
-  VSI->SELECT = type;
-
   /* Retrieve current full scale setting */
-  data[0] = VSI->SCALE;
+  data[0] = h->VSI->SCALE(type);
 
   return (1U);
 }
 
 
-int32_t Sensor_GetScale (uint32_t type) {
+int32_t Sensor_GetScale (Sensor_Handle_t h, uint32_t type) {
   int32_t scale;
 
-  if (IsTypeValid(type) == 0U) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
-  /* Select sensor */
-  VSI->SELECT = type;
-
   /* Retrieve current full scale setting */
-  scale = VSI->SCALE;
+  scale = h->VSI->SCALE(type);
 
   return (scale);
 }
 
 
-int32_t Sensor_SetScale (uint32_t type, int32_t data) {
+int32_t Sensor_SetScale (Sensor_Handle_t h, uint32_t type, int32_t data) {
   int32_t scale;
 
-  if (IsTypeValid(type) == 0U) {
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
     return (SENSOR_INVALID_PARAMETER);
   }
 
-  /* Select sensor */
-  VSI->SELECT = type;
-
   /* Set full scale setting */
-  VSI->SCALE = data;
+  h->VSI->SCALE(type) = data;
+
+#if (SENSOR_RING_ENABLE != 0)
+  /* Update scale used by read functions */
+  h->Ring[type].Scale = (int32_t)h->VSI->SCALE(type);
+#endif
+
+  return (SENSOR_OK);
+}
+
+
+int32_t Sensor_SetWatermark (Sensor_Handle_t h, uint32_t type, uint32_t watermark) {
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (watermark == 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  /* Set number of samples that trigger interrupt */
+  h->VSI->WATERMARK(type) = watermark;
+
+  TimerUpdate(h);
+
+  return (SENSOR_OK);
+}
+
+
+int32_t Sensor_SetLatency (Sensor_Handle_t h, uint32_t latency) {
+
+  if (h == NULL) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  /* Set maximum time a sample waits in FIFO before interrupt */
+  h->VSI->LATENCY = latency;
+
+  TimerUpdate(h);
 
   return (SENSOR_OK);
 }
+
+
+int32_t Sensor_GetOverruns (Sensor_Handle_t h, uint32_t type) {
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  /* Read number of samples lost since sensor was enabled */
+  return ((int32_t)h->VSI->OVERRUN(type));
+}
+
+
+int32_t Sensor_StreamStart (Sensor_Handle_t h, uint32_t type, void *buf, uint32_t block_size, uint32_t block_num) {
+  uint32_t entries;
+  uint32_t odr;
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (buf == NULL) || (((uintptr_t)buf & 3U) != 0U) ||
+      (block_num < 2U) || ((block_num & (block_num - 1U)) != 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  entries = GetEntries(type);
+
+  if ((block_size == 0U) || ((block_size % (entries * 4U)) != 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  if (h->Stream.Active != 0U) {
+    /* Single DMA stream per VSI peripheral */
+    return (SENSOR_BUSY);
+  }
+
+  odr = h->VSI->ODR(type);
+  if (odr == 0U) {
+    return (SENSOR_ERROR);
+  }
+
+  /* Stop timer and DMA */
+  h->VSI->Timer.Control = 0U;
+  h->VSI->DMA.Control   = 0U;
+  h->TimerArmed         = 0U;
+
+  /* Timer overflows counted before streaming (one-shot deadlines) did not
+     transfer blocks, stream starts at the overflow count of the stopped
+     timer while DMA starts writing at block 0 of the ring buffer */
+  h->Stream.Base  = h->VSI->Timer.Count;
+  h->Stream.RdCnt = h->Stream.Base;
+
+  h->Stream.Type      = type;
+  h->Stream.Buf       = (uint8_t *)buf;
+  h->Stream.BlockSize = block_size;
+  h->Stream.BlockNum  = block_num;
+  h->Stream.Active    = 1U;
+
+  /* Route sensor samples to DMA and enable sensor */
+  h->VSI->STREAM = SENSOR_STREAM_ENABLE | type;
+  h->VSI->ENABLE(type) = 1U;
+
+  /* Configure DMA ring buffer */
+  h->VSI->DMA.Address   = (uint32_t)(uintptr_t)buf;
+  h->VSI->DMA.BlockSize = block_size;
+  h->VSI->DMA.BlockNum  = block_num;
+  h->VSI->DMA.Control   = ARM_VSI_DMA_Direction_P2M |
+                          ARM_VSI_DMA_Enable_Msk;
+
+  /* Timer transfers one block per block period */
+  h->VSI->Timer.Interval = (block_size / (entries * 4U)) * odr;
+  h->VSI->Timer.Control  = ARM_VSI_Timer_Trig_DMA_Msk |
+                           ARM_VSI_Timer_Trig_IRQ_Msk |
+                           ARM_VSI_Timer_Periodic_Msk |
+                           ARM_VSI_Timer_Run_Msk;
+
+  return (SENSOR_OK);
+}
+
+
+int32_t Sensor_StreamStop (Sensor_Handle_t h, uint32_t type) {
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  if ((h->Stream.Active == 0U) || (h->Stream.Type != type)) {
+    return (SENSOR_ERROR);
+  }
+
+  /* Stop timer and DMA */
+  h->VSI->Timer.Control = 0U;
+  h->VSI->DMA.Control   = 0U;
+
+  h->Stream.Active = 0U;
+
+  /* Route sensor samples back to FIFO */
+  h->VSI->STREAM = 0U;
+
+  /* Resume servicing of enabled sensors */
+  TimerStart(h);
+
+  return (SENSOR_OK);
+}
+
+
+int32_t Sensor_ReadBlock (Sensor_Handle_t h, uint32_t type, int32_t *data, uint32_t len) {
+  uint32_t num;
+  uint32_t cnt;
+
+  if ((h == NULL) || (IsTypeValid(type) == 0U) || (data == NULL)) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  if ((h->Stream.Active == 0U) || (h->Stream.Type != type)) {
+    return (SENSOR_ERROR);
+  }
+
+  num = h->Stream.BlockSize / 4U;
+
+  if (len < num) {
+    return (SENSOR_INVALID_PARAMETER);
+  }
+
+  do {
+    /* Number of blocks written by DMA (one block per timer overflow) */
+    cnt = h->VSI->Timer.Count;
+
+    if (cnt == h->Stream.RdCnt) {
+      /* No block available */
+      return (0);
+    }
+
+    /* Block following the newest one is reserved for the next DMA transfer */
+    if ((cnt - h->Stream.RdCnt) >= h->Stream.BlockNum) {
+      /* Ring buffer overrun, skip to the oldest valid block */
+      h->Stream.RdCnt = cnt - (h->Stream.BlockNum - 1U);
+    }
+
+    memcpy(data, &h->Stream.Buf[((h->Stream.RdCnt - h->Stream.Base) & (h->Stream.BlockNum - 1U)) * h->Stream.BlockSize], h->Stream.BlockSize);
+
+    /* Repeat when block was overwritten while being copied */
+  } while ((h->VSI->Timer.Count - h->Stream.RdCnt) >= h->Stream.BlockNum);
+
+  h->Stream.RdCnt++;
+
+  return ((int32_t)num);
+}
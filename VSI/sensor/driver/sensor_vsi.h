@@ -19,4 +19,39 @@
 #define SENSOR_STATUS_FIFO_NE_PRESS   (1 << SID_PRESS)
 #define SENSOR_STATUS_FIFO_NE_ACC     (1 << SID_ACC  )
 #define SENSOR_STATUS_FIFO_NE_GYRO    (1 << SID_GYRO )
-#define SENSOR_STATUS_FIFO_NE_MAG     (1 << SID_MAG  )
\ No newline at end of file
+#define SENSOR_STATUS_FIFO_NE_MAG     (1 << SID_MAG  )
+#define SENSOR_STATUS_OVERRUN_TEMP    (1 << (8 + SID_TEMP ))
+#define SENSOR_STATUS_OVERRUN_HUM     (1 << (8 + SID_HUM  ))
+#define SENSOR_STATUS_OVERRUN_PRESS   (1 << (8 + SID_PRESS))
+#define SENSOR_STATUS_OVERRUN_ACC     (1 << (8 + SID_ACC  ))
+#define SENSOR_STATUS_OVERRUN_GYRO    (1 << (8 + SID_GYRO ))
+#define SENSOR_STATUS_OVERRUN_MAG     (1 << (8 + SID_MAG  ))
+
+/* User register map: global registers */
+#define SENSOR_REG_STATUS             0U
+#define SENSOR_REG_INTERVAL           1U
+#define SENSOR_REG_STREAM             2U
+#define SENSOR_REG_LATENCY            3U
+
+/* User register map: per-sensor register banks */
+#define SENSOR_REG_BANK_BASE          16U
+#define SENSOR_REG_BANK_SIZE          8U
+#define SENSOR_REG_BANK(sid)          (SENSOR_REG_BANK_BASE + ((sid) * SENSOR_REG_BANK_SIZE))
+
+/* Register offsets within sensor register bank */
+#define SENSOR_REG_ENABLE             0U
+#define SENSOR_REG_SCALE              1U
+#define SENSOR_REG_ODR                2U
+#define SENSOR_REG_FIFO_CNT           3U
+#define SENSOR_REG_FIFO               4U
+#define SENSOR_REG_FIFO_TS            5U   /* Timestamp in us, modulo 2^32 */
+#define SENSOR_REG_WATERMARK          6U
+#define SENSOR_REG_OVERRUN            7U
+
+/* STREAM register definitions */
+#define SENSOR_STREAM_SID_Msk         0xFFU
+#define SENSOR_STREAM_ENABLE          (1U << 8)
+
+/* Number of FIFO entries per sample */
+#define SENSOR_ENTRIES_ENV            1U
+#define SENSOR_ENTRIES_MOTION         3U
\ No newline at end of file
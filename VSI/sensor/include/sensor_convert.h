@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022 Arm Limited. All rights reserved.
+ */
+
+#ifndef SENSOR_CONVERT_H__
+#define SENSOR_CONVERT_H__
+
+#ifdef  __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/**
+  \fn          void Sensor_ConvertData (const int32_t *src, float *dst, uint32_t num, int32_t scale)
+  \brief       Convert raw FIFO entries to scaled sensor data (dst[i] = src[i] / scale).
+  \param[in]   src   pointer to array of raw FIFO entries
+  \param[out]  dst   pointer to array that stores sensor data
+  \param[in]   num   number of entries to convert
+  \param[in]   scale sensitivity scale (0 = invalid, all data set to 0)
+*/
+void Sensor_ConvertData (const int32_t *src, float *dst, uint32_t num, int32_t scale);
+
+/**
+  \fn          void Sensor_ConvertAxes (const int32_t *src, float *x, float *y, float *z, uint32_t num, int32_t scale)
+  \brief       Convert raw interleaved 3-axis FIFO entries (x, y, z, x, y, z, ...) to scaled per-axis data.
+  \param[in]   src   pointer to array of raw FIFO entries (3 * num entries)
+  \param[out]  x     pointer to array that stores x axis data
+  \param[out]  y     pointer to array that stores y axis data
+  \param[out]  z     pointer to array that stores z axis data
+  \param[in]   num   number of samples to convert
+  \param[in]   scale sensitivity scale (0 = invalid, all data set to 0)
+*/
+void Sensor_ConvertAxes (const int32_t *src, float *x, float *y, float *z, uint32_t num, int32_t scale);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /* SENSOR_CONVERT_H__ */
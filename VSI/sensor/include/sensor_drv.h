@@ -27,6 +27,13 @@ extern "C"
 #define SENSOR_EVENT_ACC_DATA_AVAILABLE   (1UL << SENSOR_TYPE_ACC)
 #define SENSOR_EVENT_GYRO_DATA_AVAILABLE  (1UL << SENSOR_TYPE_GYRO)
 #define SENSOR_EVENT_MAG_DATA_AVAILABLE   (1UL << SENSOR_TYPE_MAG)
+#define SENSOR_EVENT_TEMP_OVERRUN         (1UL << (8 + SENSOR_TYPE_TEMP))
+#define SENSOR_EVENT_HUM_OVERRUN          (1UL << (8 + SENSOR_TYPE_HUM))
+#define SENSOR_EVENT_PRESS_OVERRUN        (1UL << (8 + SENSOR_TYPE_PRESS))
+#define SENSOR_EVENT_ACC_OVERRUN          (1UL << (8 + SENSOR_TYPE_ACC))
+#define SENSOR_EVENT_GYRO_OVERRUN         (1UL << (8 + SENSOR_TYPE_GYRO))
+#define SENSOR_EVENT_MAG_OVERRUN          (1UL << (8 + SENSOR_TYPE_MAG))
+#define SENSOR_EVENT_BLOCK_AVAILABLE      (1UL << 16)  ///< Streamed data block available
 
 /* Return Codes */
 #define SENSOR_OK                         (0)  ///< Operation succeeded
@@ -37,46 +44,68 @@ extern "C"
 #define SENSOR_INVALID_PARAMETER          (-5) ///< Parameter error
 
 
+/* Number of Sensor Interface instances (one per VSI peripheral) */
+#define SENSOR_INSTANCE_COUNT             8U
+
+/**
+  \brief       Sensor Interface handle (instance of the driver bound to a VSI peripheral)
+*/
+typedef struct Sensor_Resources_s *Sensor_Handle_t;
+
 /**
   \fn          Sensor_Event_t
-  \brief       Sensor Interface Event callback function type: void (*Sensor_Event_t) (uint32_t event)
+  \brief       Sensor Interface Event callback function type: void (*Sensor_Event_t) (Sensor_Handle_t h, uint32_t event)
+  \param[in]   h     sensor interface handle
   \param[in]   event events notification mask
   \return      none
 */
-typedef void (*Sensor_Event_t) (uint32_t event);
+typedef void (*Sensor_Event_t) (Sensor_Handle_t h, uint32_t event);
+
+/**
+  \fn          Sensor_Handle_t Sensor_GetHandle (uint32_t instance)
+  \brief       Get Sensor Interface handle.
+  \param[in]   instance VSI peripheral instance (0 .. SENSOR_INSTANCE_COUNT-1)
+  \return      sensor interface handle, NULL when instance is not enabled in sensor_drv_config.h
+*/
+Sensor_Handle_t Sensor_GetHandle (uint32_t instance);
 
 /**
-  \fn          int32_t Sensor_Initialize (Sensor_Event_t cb_event)
+  \fn          int32_t Sensor_Initialize (Sensor_Handle_t h, Sensor_Event_t cb_event)
   \brief       Initialize Sensor Interface.
+  \param[in]   h        sensor interface handle
   \param[in]   cb_event pointer to \ref Sensor_Event_t
   \return      return code
 */
-int32_t Sensor_Initialize (Sensor_Event_t cb_event);
+int32_t Sensor_Initialize (Sensor_Handle_t h, Sensor_Event_t cb_event);
 
 /**
-  \fn          int32_t Sensor_Uninitialize (void)
+  \fn          int32_t Sensor_Uninitialize (Sensor_Handle_t h)
   \brief       De-initialize Sensor Interface.
+  \param[in]   h sensor interface handle
   \return      return code
 */
-int32_t Sensor_Uninitialize (void);
+int32_t Sensor_Uninitialize (Sensor_Handle_t h);
 
 /**
-  \fn          int32_t Sensor_Enable (uint32_t type)
+  \fn          int32_t Sensor_Enable (Sensor_Handle_t h, uint32_t type)
   \brief       Enable Sensor Interface.
+  \param[in]   h sensor interface handle
   \return      return code
 */
-int32_t Sensor_Enable (uint32_t type);
+int32_t Sensor_Enable (Sensor_Handle_t h, uint32_t type);
 
 /**
-  \fn          int32_t Sensor_Disable (uint32_t type)
+  \fn          int32_t Sensor_Disable (Sensor_Handle_t h, uint32_t type)
   \brief       Disable Sensor Interface.
+  \param[in]   h sensor interface handle
   \return      return code
 */
-int32_t Sensor_Disable (uint32_t type);
+int32_t Sensor_Disable (Sensor_Handle_t h, uint32_t type);
 
 /**
-  \fn          int32_t Sensor_MotionReadData (uint32_t type, float *x, float *y, float *z)
+  \fn          int32_t Sensor_MotionReadData (Sensor_Handle_t h, uint32_t type, float *x, float *y, float *z)
   \brief       Read motion sensor data.
+  \param[in]   h    sensor interface handle
   \param[in]   type sensor type
   \param[in]   x    pointer to variable that stores x axis data
   \param[in]   y    pointer to variable that stores y axis data
@@ -84,68 +113,205 @@ int32_t Sensor_Disable (uint32_t type);
   \return      >=0 number of data items available to read
                < 0 return code
 */
-int32_t Sensor_MotionReadData (uint32_t type, float *x, float *y, float *z);
+int32_t Sensor_MotionReadData (Sensor_Handle_t h, uint32_t type, float *x, float *y, float *z);
 //int32_t Sensor_ReadAxes (uint32_t type, float *x, float *y, float *z);
 
 /**
-  \fn          int32_t Sensor_EnvReadData (uint32_t type, float *data)
+  \fn          int32_t Sensor_EnvReadData (Sensor_Handle_t h, uint32_t type, float *data)
   \brief       Read environmental sensor data.
+  \param[in]   h    sensor interface handle
   \param[in]   type sensor type
   \param[in]   data pointer to data variable
   \return      >=0 number of data items available to read
                < 0 return code
 */
-int32_t Sensor_EnvReadData (uint32_t type, float *data);
+int32_t Sensor_EnvReadData (Sensor_Handle_t h, uint32_t type, float *data);
 //int32_t Sensor_ReadData (uint32_t type, float *data);
 
 /**
-  \fn          int32_t Sensor_QueryInterval (uint32_t type, uint32_t period[], uint32_t len)
+  \fn          int32_t Sensor_ReadSamples (Sensor_Handle_t h, uint32_t type, float *buf, uint32_t max)
+  \brief       Read multiple samples from sensor FIFO.
+  \param[in]   h    sensor interface handle
+  \param[in]   type sensor type
+  \param[out]  buf  pointer to array that stores data (x, y, z interleaved for motion sensors)
+  \param[in]   max  maximum number of data items to read (multiple of 3 for motion sensors)
+  \return      >=0 number of data items read
+               < 0 return code
+*/
+int32_t Sensor_ReadSamples (Sensor_Handle_t h, uint32_t type, float *buf, uint32_t max);
+
+/**
+  \fn          int32_t Sensor_ReadSamplesRaw (Sensor_Handle_t h, uint32_t type, int32_t *buf, uint32_t max, int32_t *scale)
+  \brief       Read multiple raw (unscaled) samples from sensor FIFO.
+  \param[in]   h     sensor interface handle
+  \param[in]   type  sensor type
+  \param[out]  buf   pointer to array that stores FIFO entries (x, y, z interleaved for motion sensors)
+  \param[in]   max   maximum number of FIFO entries to read (multiple of 3 for motion sensors)
+  \param[out]  scale pointer to variable that stores sensitivity scale (value = entry / scale), can be NULL
+  \return      >=0 number of FIFO entries read
+               < 0 return code
+*/
+int32_t Sensor_ReadSamplesRaw (Sensor_Handle_t h, uint32_t type, int32_t *buf, uint32_t max, int32_t *scale);
+
+/**
+  \fn          int32_t Sensor_ReadSamplesQ31 (Sensor_Handle_t h, uint32_t type, int32_t *buf, uint32_t max, uint32_t range)
+  \brief       Read multiple samples from sensor FIFO in Q31 fixed-point format.
+  \param[in]   h     sensor interface handle
+  \param[in]   type  sensor type
+  \param[out]  buf   pointer to array that stores Q31 data (x, y, z interleaved for motion sensors)
+  \param[in]   max   maximum number of data items to read (multiple of 3 for motion sensors)
+  \param[in]   range full scale range in sensor units (Q31 value = data / range, saturated)
+  \return      >=0 number of data items read
+               < 0 return code
+*/
+int32_t Sensor_ReadSamplesQ31 (Sensor_Handle_t h, uint32_t type, int32_t *buf, uint32_t max, uint32_t range);
+
+/**
+  \fn          int32_t Sensor_ReadSamplesQ15 (Sensor_Handle_t h, uint32_t type, int16_t *buf, uint32_t max, uint32_t range)
+  \brief       Read multiple samples from sensor FIFO in Q15 fixed-point format.
+  \param[in]   h     sensor interface handle
+  \param[in]   type  sensor type
+  \param[out]  buf   pointer to array that stores Q15 data (x, y, z interleaved for motion sensors)
+  \param[in]   max   maximum number of data items to read (multiple of 3 for motion sensors)
+  \param[in]   range full scale range in sensor units (Q15 value = data / range, saturated)
+  \return      >=0 number of data items read
+               < 0 return code
+*/
+int32_t Sensor_ReadSamplesQ15 (Sensor_Handle_t h, uint32_t type, int16_t *buf, uint32_t max, uint32_t range);
+
+/**
+  \fn          int32_t Sensor_ReadSamplesTs (Sensor_Handle_t h, uint32_t type, uint32_t *ts, float *buf, uint32_t max)
+  \brief       Read multiple samples together with their timestamps from sensor FIFO.
+  \param[in]   h    sensor interface handle
+  \param[in]   type sensor type
+  \param[out]  ts   pointer to array that stores sample timestamps in microseconds (one per sample)
+  \param[out]  buf  pointer to array that stores data (x, y, z interleaved for motion sensors)
+  \param[in]   max  maximum number of data items to read (multiple of 3 for motion sensors)
+  \return      >=0 number of data items read
+               < 0 return code
+  \note        Timestamps are modulo 2^32 and wrap around after about 71.6 minutes.
+               Use unsigned 32-bit subtraction for time differences, or extend them
+               to 64 bits by accumulating differences of consecutive timestamps.
+*/
+int32_t Sensor_ReadSamplesTs (Sensor_Handle_t h, uint32_t type, uint32_t *ts, float *buf, uint32_t max);
+
+/**
+  \fn          int32_t Sensor_QueryInterval (Sensor_Handle_t h, uint32_t type, uint32_t period[], uint32_t len)
   \brief       Retrieve available sensor data sampling intervals
+  \param[in]   h        sensor interface handle
   \param[in]   type     sensor type
   \param[in]   interval pointer to array that stores sampling interval in microseconds
   \param[in]   len      interval array length
   \return      number of valid fields in data array
 */
-int32_t Sensor_QueryInterval (uint32_t type, uint32_t interval[], uint32_t len);
+int32_t Sensor_QueryInterval (Sensor_Handle_t h, uint32_t type, uint32_t interval[], uint32_t len);
 
 /**
-  \fn          uint32_t Sensor_GetInterval (uint32_t type)
+  \fn          uint32_t Sensor_GetInterval (Sensor_Handle_t h, uint32_t type)
   \brief       Get sensor sampling interval.
+  \param[in]   h sensor interface handle
   \return      sensor sampling interval in microseconds
 */
-uint32_t Sensor_GetInterval (uint32_t type);
+uint32_t Sensor_GetInterval (Sensor_Handle_t h, uint32_t type);
 
 /**
-  \fn          int32_t Sensor_SetInterval (uint32_t type, uint32_t period)
+  \fn          int32_t Sensor_SetInterval (Sensor_Handle_t h, uint32_t type, uint32_t period)
   \brief       Set sensor sampling interval.
+  \param[in]   h        sensor interface handle
   \param[in]   interval sampling interval in microseconds
   \return      return code
 */
-int32_t Sensor_SetInterval (uint32_t type, uint32_t interval);
+int32_t Sensor_SetInterval (Sensor_Handle_t h, uint32_t type, uint32_t interval);
 
 /**
-  \fn          int32_t Sensor_QueryScale (uint32_t type, int32_t data[], uint32_t len)
+  \fn          int32_t Sensor_QueryScale (Sensor_Handle_t h, uint32_t type, int32_t data[], uint32_t len)
   \brief       Retrieve sensor sensitivity scale range.
+  \param[in]   h    sensor interface handle
   \param[in]   type sensor type
   \param[in]   data pointer to array of integers
   \param[in]   len  data array length
   \return      number of valid fields in data array
 */
-int32_t Sensor_QueryScale (uint32_t type, int32_t data[], uint32_t len);
+int32_t Sensor_QueryScale (Sensor_Handle_t h, uint32_t type, int32_t data[], uint32_t len);
 
 /**
-  \fn          int32_t Sensor_GetScale (uint32_t type)
+  \fn          int32_t Sensor_GetScale (Sensor_Handle_t h, uint32_t type)
   \brief       Get sensor sensitivity scale.
+  \param[in]   h sensor interface handle
   \return      sensitivity scale
 */
-int32_t Sensor_GetScale (uint32_t type);
+int32_t Sensor_GetScale (Sensor_Handle_t h, uint32_t type);
 
 /**
-  \fn          int32_t Sensor_SetScale (uint32_t type, int32_t data)
+  \fn          int32_t Sensor_SetScale (Sensor_Handle_t h, uint32_t type, int32_t data)
   \brief       Set sensor sensitivity scale.
+  \param[in]   h sensor interface handle
+  \return      return code
+*/
+int32_t Sensor_SetScale (Sensor_Handle_t h, uint32_t type, int32_t data);
+
+/**
+  \fn          int32_t Sensor_SetWatermark (Sensor_Handle_t h, uint32_t type, uint32_t watermark)
+  \brief       Set FIFO watermark (number of samples in FIFO that triggers data available event).
+  \param[in]   h         sensor interface handle
+  \param[in]   type      sensor type
+  \param[in]   watermark number of samples (default 1)
+  \return      return code
+*/
+int32_t Sensor_SetWatermark (Sensor_Handle_t h, uint32_t type, uint32_t watermark);
+
+/**
+  \fn          int32_t Sensor_SetLatency (Sensor_Handle_t h, uint32_t latency)
+  \brief       Set maximum latency of data available event when FIFO is below watermark.
+  \param[in]   h       sensor interface handle
+  \param[in]   latency maximum time a sample waits in FIFO in microseconds (0 = no limit)
+  \return      return code
+*/
+int32_t Sensor_SetLatency (Sensor_Handle_t h, uint32_t latency);
+
+/**
+  \fn          int32_t Sensor_GetOverruns (Sensor_Handle_t h, uint32_t type)
+  \brief       Get number of samples lost because sensor FIFO was full.
+  \param[in]   h    sensor interface handle
+  \param[in]   type sensor type
+  \return      >=0 number of samples lost since sensor was enabled
+               < 0 return code
+*/
+int32_t Sensor_GetOverruns (Sensor_Handle_t h, uint32_t type);
+
+/**
+  \fn          int32_t Sensor_StreamStart (Sensor_Handle_t h, uint32_t type, void *buf, uint32_t block_size, uint32_t block_num)
+  \brief       Start streaming sensor data in blocks using VSI DMA.
+  \param[in]   h          sensor interface handle
+  \param[in]   type       sensor type
+  \param[in]   buf        pointer to ring buffer memory (block_size * block_num bytes, 4-byte aligned)
+  \param[in]   block_size block size in bytes (multiple of 4, multiple of 12 for motion sensors)
+  \param[in]   block_num  number of blocks in ring buffer (must be 2^n, at least 2;
+                          one block is reserved for the ongoing DMA transfer)
+  \return      return code
+*/
+int32_t Sensor_StreamStart (Sensor_Handle_t h, uint32_t type, void *buf, uint32_t block_size, uint32_t block_num);
+
+/**
+  \fn          int32_t Sensor_StreamStop (Sensor_Handle_t h, uint32_t type)
+  \brief       Stop streaming sensor data.
+  \param[in]   h    sensor interface handle
+  \param[in]   type sensor type
   \return      return code
 */
-int32_t Sensor_SetScale (uint32_t type, int32_t data);
+int32_t Sensor_StreamStop (Sensor_Handle_t h, uint32_t type);
+
+/**
+  \fn          int32_t Sensor_ReadBlock (Sensor_Handle_t h, uint32_t type, int32_t *data, uint32_t len)
+  \brief       Read oldest block of streamed sensor data (raw FIFO entries).
+  \param[in]   h    sensor interface handle
+  \param[in]   type sensor type
+  \param[out]  data pointer to array that stores FIFO entries
+  \param[in]   len  data array length (at least block_size / 4)
+  \return      >=0 number of FIFO entries read (0 when no block is available)
+               < 0 return code
+*/
+int32_t Sensor_ReadBlock (Sensor_Handle_t h, uint32_t type, int32_t *data, uint32_t len);
 
 #ifdef  __cplusplus
 }
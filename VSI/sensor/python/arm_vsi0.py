@@ -1,6 +1,10 @@
 # Copyright (c) 2021 Arm Limited. All rights reserved.
 
 # Virtual Streaming Interface instance 0 Python script: Sensor Interface
+#
+# The same model serves VSI instances 1 to 7 (loaders arm_vsi1.py to
+# arm_vsi7.py), each loaded as a separate module with its own registers,
+# data file and log prefix.
 
 ##@addtogroup arm_vsi0_py_sensor
 #  @{
@@ -10,21 +14,110 @@
 #
 #More details.
 
+import atexit
+import concurrent.futures
+import gzip
+import hashlib
+import io
+import json
+import lzma
 import math
 import logging
 import os
+import re
+import mmap
+import random
+import shutil
+import struct
+import sys
+import tempfile
+from array import array
+from bisect import bisect_left, bisect_right
+
+# VSI instance number (derived from module name arm_vsi<n>)
+_m = re.search(r"arm_vsi(\d)", __name__)
+INSTANCE = int(_m.group(1)) if _m else 0
 
 ## Set verbosity level
-verbosity = logging.DEBUG
-#verbosity = logging.ERROR
+#verbosity = logging.DEBUG
+verbosity = logging.ERROR
 
 # [debugging] Verbosity settings
 level = { 10: "DEBUG",  20: "INFO",  30: "WARNING",  40: "ERROR" }
-logging.basicConfig(format='Py: VSI0: [%(levelname)s]\t%(message)s', level = verbosity)
-logging.info("Verbosity level is set to " + level[verbosity])
-
-# Input File Name
-FILE_NAME_SENSOR = "..\\sensor_samples0.csv"
+logging.basicConfig(format='Py: %(name)s: [%(levelname)s]\t%(message)s', level = verbosity)
+log = logging.getLogger("VSI{}".format(INSTANCE))
+log.info("Verbosity level is set to " + level[verbosity])
+
+## Set register access trace (number of records in ring buffer, 0 = off)
+# Trace is written to FILE_NAME_TRACE at exit, decode it with trace_decode.py
+trace = 0
+#trace = 65536
+
+# Trace File Name
+FILE_NAME_TRACE = "vsi{}_trace.bin".format(INSTANCE)
+
+# Input File Name (CSV or binary format, optionally gzip or xz compressed)
+FILE_NAME_SENSOR = os.path.join("..", "sensor_samples{}.csv".format(INSTANCE))
+
+# Scenario File Name (can be selected with environment variable VSI<n>_SCENARIO)
+FILE_NAME_SCENARIO = os.environ.get("VSI{}_SCENARIO".format(INSTANCE),
+                                    os.path.join("..", "sensor_scenario{}.json".format(INSTANCE)))
+
+# Playback modes
+PLAYBACK_ODR       = 0      # Samples produced at fixed output data rate
+PLAYBACK_TIMESTAMP = 1      # Samples produced at recorded timestamps
+
+## Set playback mode
+playback = PLAYBACK_ODR
+#playback = PLAYBACK_TIMESTAMP
+
+# Resampling modes (ODR playback)
+RESAMPLE_NONE   = 0         # Recorded samples are played back one by one
+RESAMPLE_LINEAR = 1         # Linear interpolation at output data rate
+RESAMPLE_SINC   = 2         # Windowed-sinc interpolation at output data rate
+
+## Set resampling mode
+resample = RESAMPLE_NONE
+#resample = RESAMPLE_LINEAR
+#resample = RESAMPLE_SINC
+
+# Windowed-sinc interpolation half-width (in recorded sample intervals)
+SINC_TAPS = 8
+
+## Set parsed data cache (CSV data files)
+# Parsed columns of enabled sensors are stored in binary format next to the
+# data file (<data file>.<sensor>.cache) and loaded directly on later runs
+# while the data file content is unchanged
+cache = 1
+#cache = 0
+
+## Set number of processes parsing complete data file (0 = number of CPUs)
+# Parallel parsing is opt-in: data files larger than two chunks are split at
+# line boundaries and the chunks are parsed in parallel only when this is
+# not 1. Model parses serially by default since process pools are not safe
+# inside the simulator's embedded interpreter (fork of a multithreaded
+# process, spawn re-launching the simulator), set it to 0 (or in scenario
+# file) to parse cold caches in parallel where the pool works. csv2bin.py
+# runs in a standalone interpreter and uses all CPUs.
+parse_workers = 1
+#parse_workers = 0
+
+# Size of data file chunk parsed by one process (in bytes)
+PARSE_CHUNK = 16 << 20
+
+# Size of data file lines parsed at once when parsing serially (in bytes)
+PARSE_LINES = 64 << 10
+
+## Set playback window (recorded timestamps in microseconds)
+# Playback starts at the first sample at or after window_start and ends after
+# the last sample at or before window_end (0 = end of recording). CSV data
+# files are positioned using timestamp index (<data file>.idx, created on
+# first use), binary data files by searching the timestamp column.
+window_start = 0
+window_end   = 0
+
+# Number of CSV data file lines between timestamp index entries
+INDEX_STRIDE = 4096
 
 CSV_Col = {
     'Timestamp' : -1,
@@ -43,6 +136,59 @@ CSV_Col = {
     'MagZ'      : -1
 }
 
+# CSV columns of sensor values (per sensor), motion sensor sample consists of
+# 3 FIFO entries
+CSV_Sensor_Cols = [
+    [ 'Temp' ],
+    [ 'Hum' ],
+    [ 'Press' ],
+    [ 'AccX',  'AccY',  'AccZ' ],
+    [ 'GyroX', 'GyroY', 'GyroZ' ],
+    [ 'MagX',  'MagY',  'MagZ' ]
+]
+
+# Number of FIFO entries read ahead from data file (per sensor)
+READ_AHEAD = 4096
+
+# Maximum number of data file lines scanned by one read (limits read-ahead of
+# sensors with sparse columns, e.g. slow sensors in a shared recording)
+READ_LINES = 16384
+
+# Binary recording format (little-endian, see csv2bin.py)
+# File header:   magic, version, number of sensor descriptors
+# Sensor header: sensor id, entries per sample, reserved, unit, scale,
+#                output data rate (in microseconds), number of FIFO entries,
+#                file offsets of timestamp (int64) and value (double) columns
+BIN_MAGIC   = b"VSIS"
+BIN_VERSION = 1
+BIN_HEADER  = struct.Struct("<4sHH")
+BIN_SENSOR  = struct.Struct("<BBH8sIIQQQ")
+
+# Compressed data files (magic bytes, decompression module), decompressed
+# while reading
+COMPRESSION = [
+    ( b"\x1f\x8b",         gzip ),
+    ( b"\xfd7zXZ\x00",     lzma )
+]
+
+# Timestamp index of CSV data file
+# Header: magic, version, timestamp column, data file size and modification
+#         time, number of entries
+# Entry:  timestamp, offset of data file line (in decompressed file)
+INDEX_MAGIC   = b"VSII"
+INDEX_VERSION = 1
+INDEX_HEADER  = struct.Struct("<4sHHQQI")
+INDEX_ENTRY   = struct.Struct("<qQ")
+
+# Parsed data cache: binary format file with single sensor followed by cache
+# key (magic, data file size and modification time, hash of column numbers,
+# hash of data file content)
+CACHE_MAGIC = b"VSICACHE"
+CACHE_KEY   = struct.Struct("<8sQQ16s32s")
+
+# Unit of sensor values (per sensor)
+UNIT = [ "degC", "%RH", "hPa", "g", "dps", "uT" ]
+
 # IRQ registers
 IRQ_Status = 0
 
@@ -53,6 +199,9 @@ Timer_Interval = 0
 # Timer callback event count
 Timer_Event = 0
 
+# Virtual time (in microseconds), advanced by timer interval on timer event
+Timer_Time = 0
+
 # Timer Control register definitions
 Timer_Control_Run_Msk      = 1<<0
 Timer_Control_Periodic_Msk = 1<<1
@@ -60,7 +209,10 @@ Timer_Control_Trig_IRQ_Msk = 1<<2
 Timer_Control_Trig_DMA_Msk = 1<<3
 
 # DMA registers
-DMA_Control = 0
+DMA_Control   = 0
+DMA_Address   = 0
+DMA_BlockSize = 0
+DMA_BlockNum  = 0
 
 # DMA Control register definitions
 DMA_Control_Enable_Msk    = 1<<0
@@ -79,16 +231,47 @@ SID_ACC   = 3
 SID_GYRO  = 4
 SID_MAG   = 5
 
+# Sensor names (scenario file and log)
+SENSOR_NAME = [ "temp", "hum", "press", "acc", "gyro", "mag" ]
+
+## Set synthetic signal sources (used instead of data file for the sensor)
+# Dictionary of sensor id and generator settings (see Generator), e.g.:
+#generator = { SID_ACC:  { 'type': 'sine', 'odr': 1000, 'frequency': 10.0 },
+#              SID_TEMP: { 'type': 'loop' } }
+generator = {}
+
+## Set sensor data files (used instead of FILE_NAME_SENSOR for the sensor)
+# Dictionary of sensor id and source settings:
+#   file    data file name (CSV or binary format)
+#   odr     output data rate in microseconds (default detected from file)
+#   columns CSV column names of sensor values (default CSV_Sensor_Cols)
+# Each sensor is read from its own file and rate, the timer is driven by the
+# earliest deadline across all sensor streams, e.g.:
+#sources = { SID_TEMP: { 'file': os.path.join("..", "temp.csv") },
+#            SID_ACC:  { 'file': os.path.join("..", "imu.bin"), 'odr': 1000 } }
+sources = {}
+
 # USER REGISTER MAPPING
 # =====================
+# Global registers
 IDX_STATUS        = 0
 IDX_INTERVAL      = 1
-IDX_SELECT        = 2
-IDX_ENABLE        = 3
-IDX_SCALE         = 4
-IDX_ODR           = 5
-IDX_FIFO_CNT      = 6
-IDX_FIFO          = 7
+IDX_STREAM        = 2
+IDX_LATENCY       = 3
+
+# Sensor register banks: Regs[IDX_BANK_BASE + sid * IDX_BANK_SIZE + offset]
+IDX_BANK_BASE     = 16
+IDX_BANK_SIZE     = 8
+
+# Register offsets within sensor register bank
+OFS_ENABLE        = 0
+OFS_SCALE         = 1
+OFS_ODR           = 2
+OFS_FIFO_CNT      = 3
+OFS_FIFO          = 4
+OFS_FIFO_TS       = 5
+OFS_WATERMARK     = 6
+OFS_OVERRUN       = 7
 
 # Status Register
 # ===============
@@ -101,18 +284,22 @@ BIT_STATUS_FIFO_NE_PRESS = 1 << SID_PRESS
 BIT_STATUS_FIFO_NE_ACC   = 1 << SID_ACC
 BIT_STATUS_FIFO_NE_GYRO  = 1 << SID_GYRO
 BIT_STATUS_FIFO_NE_MAG   = 1 << SID_MAG
+BIT_STATUS_OVERRUN_TEMP  = 1 << (8 + SID_TEMP)
+BIT_STATUS_OVERRUN_HUM   = 1 << (8 + SID_HUM)
+BIT_STATUS_OVERRUN_PRESS = 1 << (8 + SID_PRESS)
+BIT_STATUS_OVERRUN_ACC   = 1 << (8 + SID_ACC)
+BIT_STATUS_OVERRUN_GYRO  = 1 << (8 + SID_GYRO)
+BIT_STATUS_OVERRUN_MAG   = 1 << (8 + SID_MAG)
 
 # INTERVAL Register
 # ===============
+# Time (in microseconds) from the last timer event to the next deadline of
+# enabled sensors (0 = nothing to service). Timer is armed one-shot with it.
 INTERVAL = 0
 
-# Sensor Select Register
-# ======================
-SELECT = 0
-
 # Enable Register
 # ===============
-# Enable (1) or Disable (0) selected sensor
+# Enable (1) or Disable (0) sensor
 ENABLE = []
 
 # Scale Register
@@ -125,7 +312,43 @@ ODR = []
 
 # Output data rate counter
 # ========================
+# Number of samples produced (per sensor) since virtual time ODR_T0, when
+# sampling started or sampling interval was changed
 ODR_CNT = []
+ODR_T0  = []
+
+# Playback mode (per sensor) and recorded timestamp of the first sample
+# produced since ODR_T0 (timestamp playback)
+PLAYBACK = []
+TS_T0    = []
+
+# Recorded timestamps available (per sensor)
+DATA_TS = []
+
+# Overrun policies
+OVERRUN_DROP_OLDEST = 0     # Oldest sample in full FIFO is overwritten
+OVERRUN_DROP_NEWEST = 1     # New sample is discarded when FIFO is full
+
+# FIFO depth (per sensor, in samples, 0 = unlimited) and overrun policy
+FIFO_DEPTH     = []
+OVERRUN_POLICY = []
+
+# Overrun Register
+# ================
+# Number of samples lost (per sensor) because FIFO was full, since sensor was
+# enabled, and overrun flag (reported and cleared by STATUS read)
+OVERRUN      = []
+OVERRUN_FLAG = []
+
+# Sensor loggers (per sensor, trace level can be set per sensor)
+SLOG = []
+
+# Resampling mode (per sensor), recorded output data rate and signal time
+# (recorded timestamp) and entry index of the sample at the head of FIFO
+RESAMPLE = []
+REC_ODR  = []
+RS_T     = []
+RS_E     = []
 
 # FIFO Count Register
 # ===================
@@ -134,14 +357,53 @@ FIFO_CNT = []
 
 # FIFO Register
 # =============
-# FIFO data buffers (per sensor)
-FIFO = []
+# FIFO data buffers (per sensor): read-ahead window of recorded sample values
+# (array of doubles), refilled from data file on demand,
+# read cursor (index of the sample at the head of FIFO) and cache of sample
+# values converted to 32-bit register values with current SCALE (array of
+# unsigned ints, built for READ_AHEAD entries from the read cursor and
+# invalidated when SCALE is written)
+FIFO           = []
+FIFO_RD        = []
+FIFO_SCALED    = []
+FIFO_SCALED_RD = []
+
+# Data file readers (per sensor, None = sensor data not present)
+READER = []
 
 # FIFO Timestamp Register
 # =======================
-# FIFO data timestamp (per sensor)
+# FIFO data timestamp (per sensor, array of 64-bit ints), register returns
+# timestamp (in microseconds) of the sample at the head of FIFO (next sample
+# to read). Register holds the low 32 bits only, so the timestamp wraps around
+# after 2^32 us (about 71.6 minutes) of a recording.
 FIFO_TS = []
 
+# Stream Register
+# ===============
+# Sensor id (bits 7..0) and enable bit (bit 8) of DMA block streaming.
+# Only one sensor can be streamed at a time, its samples bypass FIFO_CNT
+# and are delivered in blocks via rdDataDMA() on each timer event.
+STREAM_SID = -1
+
+# Bit definitions
+BIT_STREAM_ENABLE = 1 << 8
+MSK_STREAM_SID    = 0xFF
+
+# Watermark Register
+# ==================
+# Number of samples in FIFO (per sensor) that triggers an interrupt
+WATERMARK = []
+
+# Latency Register
+# ================
+# Maximum time (in microseconds) a sample waits in FIFO before an interrupt
+# is triggered regardless of watermark (0 = no latency limit)
+LATENCY = 0
+
+# Virtual time when FIFO became non-empty (per sensor)
+FIFO_T0 = []
+
 ## Create and initialize user registers
 def CreateUserRegisters():
 
@@ -151,9 +413,28 @@ def CreateUserRegisters():
         SCALE.append(list())
         ODR.append(list())
         ODR_CNT.append(list())
+        ODR_T0.append(list())
+        PLAYBACK.append(list())
+        TS_T0.append(list())
+        RESAMPLE.append(list())
+        REC_ODR.append(list())
+        RS_T.append(list())
+        RS_E.append(list())
+        DATA_TS.append(list())
+        FIFO_DEPTH.append(list())
+        OVERRUN_POLICY.append(list())
+        OVERRUN.append(list())
+        OVERRUN_FLAG.append(list())
+        SLOG.append(log.getChild(SENSOR_NAME[i].upper()))
         FIFO_CNT.append(list())
-        FIFO.append(list())
-        FIFO_TS.append(list())
+        FIFO.append(array('d'))
+        FIFO_RD.append(0)
+        FIFO_SCALED.append(None)
+        FIFO_SCALED_RD.append(0)
+        FIFO_TS.append(array('q'))
+        READER.append(None)
+        WATERMARK.append(list())
+        FIFO_T0.append(list())
 
     # Initialize registers
     for i in range(SENSOR_COUNT):
@@ -161,209 +442,1391 @@ def CreateUserRegisters():
         SCALE[i]    = 100000
         ODR[i]      = 0
         ODR_CNT[i]  = 0
+        ODR_T0[i]   = 0
+        PLAYBACK[i] = playback
+        TS_T0[i]    = 0
+        RESAMPLE[i] = resample
+        REC_ODR[i]  = 0
+        RS_T[i]     = 0
+        RS_E[i]     = 0
+        DATA_TS[i]  = 0
+        FIFO_DEPTH[i]     = 0
+        OVERRUN_POLICY[i] = OVERRUN_DROP_OLDEST
+        OVERRUN[i]        = 0
+        OVERRUN_FLAG[i]   = 0
         FIFO_CNT[i] = 0
+        WATERMARK[i] = 1
+        FIFO_T0[i]  = 0
+
+## Get decompression module of a data file
+#  @param file_name data file name
+#  @return gzip or lzma module, None when file is not compressed
+def Decompressor(file_name):
+    with open(file_name, "rb") as f:
+        magic = f.read(6)
+
+    for m, module in COMPRESSION:
+        if magic.startswith(m):
+            return module
+    return None
+
+## Open data file, compressed file is decompressed while reading
+#  @param file_name data file name
+#  @param mode "rt" (text) or "rb" (binary)
+#  @return file object
+def openFile(file_name, mode):
+    module = Decompressor(file_name)
+
+    if module is None:
+        return open(file_name, mode)
+    return module.open(file_name, mode)
+
+## Parse values of several sensors from a data file line
+#  @param line data file line
+#  @param sensors list of (cols, val, ts) per sensor: column numbers of
+#         sensor values and arrays where sample values and timestamps are
+#         appended
+#  @param ts_col column number of timestamp (-1 = not present)
+def parseLineSensors(line, sensors, ts_col):
+    data = line.split(",")
+
+    if ts_col != -1 and data[ts_col].strip() != "":
+        Ts = int(data[ts_col])
+    else:
+        Ts = 0
+
+    for cols, val, ts in sensors:
+        for col in cols:
+            item = data[col].strip()
+            if item != "":
+                val.append(float(item))
+                ts.append(Ts)
+
+## Parse sensor values of a data file line
+#  @param line data file line
+#  @param cols list of column numbers of sensor values
+#  @param ts_col column number of timestamp (-1 = not present)
+#  @param val array where sample values are appended
+#  @param ts array where sample timestamps are appended
+def parseLine(line, cols, ts_col, val, ts):
+    parseLineSensors(line, ((cols, val, ts),), ts_col)
+
+## Sensor data file reader
+# Each sensor reads the data file through its own file handle, so sensors
+# consumed at different rates do not buffer samples of each other and only a
+# bounded window of the recording is held in memory.
+class CSVReader:
+
+    ## Open data file and skip header
+    #  @param file_name data file name
+    #  @param cols list of column numbers of sensor values
+    #  @param ts_col column number of timestamp (-1 = not present)
+    #  @param offset offset of first line to read (0 = line after header)
+    def __init__(self, file_name, cols, ts_col, offset=0):
+        self.f        = openFile(file_name, "rt")
+        self.name     = file_name
+        self.cols     = cols
+        self.ts_col   = ts_col
+        self.offset   = offset
+        self.eof      = False
+        self.count    = 0
+        self.first_ts = None
+
+        self.f.readline()
+        if offset != 0:
+            self.f.seek(offset)
+
+    ## Open new reader at recording start
+    #  @return reader
+    def reopen(self):
+        return CSVReader(self.name, self.cols, self.ts_col, self.offset)
+
+    ## Read sensor FIFO entries
+    # Reading stops after READ_LINES lines, so fewer entries (even none) may
+    # be returned for sparse columns.
+    #  @param n number of entries to read (at least, unless end of file or
+    #         READ_LINES lines were scanned)
+    #  @param val array where sample values are appended
+    #  @param ts array where sample timestamps are appended
+    def read(self, n, val, ts):
+        start = len(val)
+        end   = start + n
+
+        for _ in range(READ_LINES):
+            if len(val) >= end:
+                break
+            line = self.f.readline()
+            if line == "":
+                self.eof = True
+                self.f.close()
+                break
+
+            parseLine(line, self.cols, self.ts_col, val, ts)
+
+        if self.first_ts is None and len(ts) > start:
+            self.first_ts = ts[start]
+
+        self.count += len(val) - start
+
+## Binary data file column reader
+# Reads memory mapped timestamp and value columns (used for replay loop).
+class ColumnReader:
+
+    ## Create column reader
+    #  @param ts timestamp column
+    #  @param val value column
+    #  @param pos index of first entry to read
+    def __init__(self, ts, val, pos=0):
+        self.ts  = ts
+        self.val = val
+        self.pos = pos
+        self.eof = pos >= len(val)
+
+    ## Open new reader at recording start
+    #  @return reader
+    def reopen(self):
+        return ColumnReader(self.ts, self.val)
+
+    ## Read sensor FIFO entries
+    #  @param n number of entries to read (unless end of column)
+    #  @param val array where sample values are appended
+    #  @param ts array where sample timestamps are appended
+    def read(self, n, val, ts):
+        end = min(self.pos + n, len(self.val))
+
+        val.extend(self.val[self.pos : end])
+        ts.extend(self.ts[self.pos : end])
+
+        self.pos = end
+        if end == len(self.val):
+            self.eof = True
+
+## Compressed binary data file reader
+# Compressed file cannot be memory mapped, timestamp and value columns of the
+# sensor are streamed through two decompressors.
+class BinReader:
+
+    ## Open columns of a sensor
+    #  @param file_name data file name
+    #  @param cnt number of FIFO entries
+    #  @param ts_ofs offset of timestamp column (in decompressed file)
+    #  @param val_ofs offset of value column (in decompressed file)
+    def __init__(self, file_name, cnt, ts_ofs, val_ofs):
+        self.name    = file_name
+        self.cnt     = cnt
+        self.ts_ofs  = ts_ofs
+        self.val_ofs = val_ofs
+        self.left    = cnt
+        self.eof     = cnt == 0
+
+        self.f_ts  = openFile(file_name, "rb")
+        self.f_val = openFile(file_name, "rb")
+        self.f_ts.seek(ts_ofs)
+        self.f_val.seek(val_ofs)
+
+    ## Open new reader at recording start
+    #  @return reader
+    def reopen(self):
+        return BinReader(self.name, self.cnt, self.ts_ofs, self.val_ofs)
+
+    ## Read sensor FIFO entries
+    #  @param n number of entries to read (unless end of column)
+    #  @param val array where sample values are appended
+    #  @param ts array where sample timestamps are appended
+    def read(self, n, val, ts):
+        n = min(n, self.left)
+
+        t = array('q', self.f_ts.read(n * 8))
+        v = array('d', self.f_val.read(n * 8))
+        if sys.byteorder != "little":
+            t.byteswap()
+            v.byteswap()
+
+        ts.extend(t)
+        val.extend(v)
+
+        self.left -= n
+        if self.left == 0 or len(v) < n:
+            self.eof = True
+            self.f_ts.close()
+            self.f_val.close()
+
+## Playback window reader
+# Skips entries recorded before window_start and ends at the last entry
+# recorded at or before window_end.
+class WindowReader:
+
+    ## Create playback window reader
+    #  @param reader data file reader (positioned at or before window start)
+    def __init__(self, reader):
+        self.reader = reader
+        self.skip   = window_start != 0
+        self.eof    = reader.eof
+
+    ## Open new reader at window start
+    #  @return reader
+    def reopen(self):
+        return WindowReader(self.reader.reopen())
+
+    ## Read sensor FIFO entries
+    #  @param n number of entries to read (at most, fewer when the data file
+    #         reader returns fewer)
+    #  @param val array where sample values are appended
+    #  @param ts array where sample timestamps are appended
+    def read(self, n, val, ts):
+        start = len(val)
+
+        while len(val) == start and not self.eof:
+            self.reader.read(n, val, ts)
+            self.eof = self.reader.eof
+
+            if self.skip:
+                k = bisect_left(ts, window_start, start)
+                if k < len(ts):
+                    self.skip = False
+                del val[start:k]
+                del ts[start:k]
+
+            if window_end != 0 and len(ts) > start and ts[-1] > window_end:
+                k = bisect_right(ts, window_end, start)
+                del val[k:]
+                del ts[k:]
+                self.eof = True
+
+## Replay loop source
+# Restarts the recording of a sensor when it ends. Timestamps continue
+# monotonically, each loop is shifted by recording span plus last interval.
+class ReplayLoop:
+
+    ## Create replay loop
+    #  @param open_reader function that opens a reader at recording start
+    def __init__(self, open_reader):
+        self.open_reader = open_reader
+        self.reader      = open_reader()
+        self.offset      = 0
+        self.first       = None
+        self.prev        = None
+        self.last        = None
+        self.eof         = False
+
+    ## Read sensor FIFO entries
+    #  @param n number of entries to read (at most, fewer when the recording
+    #         reader returns fewer)
+    #  @param val array where sample values are appended
+    #  @param ts array where sample timestamps are appended
+    def read(self, n, val, ts):
+        start = len(val)
+
+        while len(val) == start:
+            if self.reader.eof:
+                if self.last is None or self.last == self.first:
+                    # Nothing to repeat
+                    self.eof = True
+                    break
+                self.offset += self.last - self.first + (self.last - self.prev)
+                self.reader  = self.open_reader()
+                self.first   = None
+
+            i = len(ts)
+            self.reader.read(n, val, ts)
+
+            for k in range(i, len(ts)):
+                t = ts[k]
+                if self.first is None:
+                    self.first = t
+                if t != self.last:
+                    self.prev = self.last if self.last is not None else t
+                    self.last = t
+                ts[k] = t + self.offset
+
+## Synthetic signal source
+# Produces samples on demand (same interface as CSVReader) with constant
+# memory. Generator settings (dictionary):
+#   type      'sine', 'chirp', 'white', 'pink' or 'step'
+#   odr       sample interval in microseconds (default 1000)
+#   samples   number of samples to produce (default 0 = endless)
+#   amplitude signal amplitude or noise standard deviation (default 1.0)
+#   offset    signal offset (default 0.0)
+#   frequency sine frequency in Hz (default 1.0)
+#   f0, f1    chirp start and end frequency in Hz (default 1.0, 100.0)
+#   duration  chirp sweep duration in seconds (default 1.0)
+#   period    step period in microseconds (default 1000000)
+#   seed      noise random seed (default sensor id)
+# Axes of motion sensors are shifted by 120 degrees (sine, chirp) or by a
+# third of period (step), noise is independent per axis.
+class Generator:
+
+    ## Create generator
+    #  @param settings generator settings
+    #  @param entries number of FIFO entries per sample
+    #  @param seed default noise random seed
+    def __init__(self, settings, entries, seed):
+        self.type      = settings.get('type', 'sine')
+        self.odr       = settings.get('odr', 1000)
+        self.samples   = settings.get('samples', 0)
+        self.amplitude = settings.get('amplitude', 1.0)
+        self.offset    = settings.get('offset', 0.0)
+        self.frequency = settings.get('frequency', 1.0)
+        self.f0        = settings.get('f0', 1.0)
+        self.f1        = settings.get('f1', 100.0)
+        self.duration  = settings.get('duration', 1.0)
+        self.period    = settings.get('period', 1000000)
+        self.rng       = random.Random(settings.get('seed', seed))
+        self.pink      = [[0.0, 0.0, 0.0] for i in range(entries)]
+        self.entries   = entries
+        self.n         = 0
+        self.eof       = False
+
+    ## Calculate signal value
+    #  @param t time (in microseconds)
+    #  @param axis entry index within sample
+    #  @return value signal value
+    def value(self, t, axis):
+        phase = 2 * math.pi * axis / 3
+        sec   = t / 1000000
+
+        if self.type == 'sine':
+            v = math.sin(2 * math.pi * self.frequency * sec + phase)
+        elif self.type == 'chirp':
+            # Linear sweep from f0 to f1, repeated every duration
+            sec %= self.duration
+            k = (self.f1 - self.f0) / self.duration
+            v = math.sin(2 * math.pi * (self.f0 * sec + k * sec * sec / 2) + phase)
+        elif self.type == 'white':
+            v = self.rng.gauss(0.0, 1.0)
+        elif self.type == 'pink':
+            # Paul Kellet's economy pink noise filter (-3 dB/octave)
+            w = self.rng.gauss(0.0, 1.0)
+            b = self.pink[axis]
+            b[0] = 0.99765 * b[0] + w * 0.0990460
+            b[1] = 0.96300 * b[1] + w * 0.2965164
+            b[2] = 0.57000 * b[2] + w * 1.0526913
+            v = (b[0] + b[1] + b[2] + w * 0.1848) / 3
+        elif self.type == 'step':
+            if (t + axis * self.period // 3) % self.period >= self.period // 2:
+                v = 1.0
+            else:
+                v = 0.0
+        else:
+            v = 0.0
 
-## Open CSV file containing sensor data
-def openDataFile(file_name):
-    global FIFO, FIFO_TS, ODR
-    logging.info("openDataFile({}) called".format(file_name))
+        return self.offset + self.amplitude * v
 
-    f = open(file_name)
+    ## Read sensor FIFO entries
+    #  @param n number of entries to read (at least, unless all produced)
+    #  @param val array where sample values are appended
+    #  @param ts array where sample timestamps are appended
+    def read(self, n, val, ts):
+        end = len(val) + n
+
+        while len(val) < end:
+            if self.samples and self.n >= self.samples:
+                self.eof = True
+                break
+
+            t = self.n * self.odr
+            for axis in range(self.entries):
+                val.append(self.value(t, axis))
+                ts.append(t)
+            self.n += 1
+
+## Get number of FIFO entries per sample
+# Motion sensor sample consists of 3 FIFO entries (x, y, z)
+#  @param sid sensor id
+#  @return number of FIFO entries per sample
+def Entries(sid):
+    if sid >= SID_ACC:
+        return 3
+    return 1
+
+## Open sensor data files configured in sources settings
+def openSources():
+    global ODR
+
+    for sid, settings in sources.items():
+        if sid >= SENSOR_COUNT:
+            continue
+
+        openDataFile(settings['file'], [sid], settings.get('columns'))
+
+        if 'odr' in settings:
+            ODR[sid] = settings['odr']
+
+## Create synthetic signal sources configured in generator settings
+def openGenerators():
+    global READER, FIFO, FIFO_TS, FIFO_RD, FIFO_SCALED, ODR, REC_ODR, RS_T, DATA_TS
+
+    for sid, settings in generator.items():
+        if sid >= SENSOR_COUNT:
+            continue
+
+        entries = Entries(sid)
+
+        if settings.get('type') == 'loop':
+            # Repeat recording of the sensor from data file
+            if READER[sid] is not None:
+                open_reader = READER[sid].reopen
+            elif len(FIFO[sid]) > 0:
+                c = (FIFO_TS[sid], FIFO[sid])
+                open_reader = lambda c=c: ColumnReader(c[0], c[1])
+            else:
+                log.warning("No sensor data to loop for SID={}".format(sid))
+                continue
+            READER[sid] = ReplayLoop(open_reader)
+        else:
+            READER[sid] = Generator(settings, entries, sid)
+            ODR[sid]     = READER[sid].odr
+            REC_ODR[sid] = READER[sid].odr
+            RS_T[sid]    = 0
+            DATA_TS[sid] = 1
+
+        # Restart FIFO window from the new source
+        FIFO[sid]        = array('d')
+        FIFO_TS[sid]     = array('q')
+        FIFO_RD[sid]     = 0
+        FIFO_SCALED[sid] = None
+
+        log.info("SID={}: {} source".format(sid, settings.get('type')))
+
+## Fill FIFO read-ahead window of a sensor from data file
+# Read-ahead beyond the required entries is limited by READ_LINES per read.
+#  @param sid sensor id
+#  @param n number of FIFO entries required in window
+#  @return number of FIFO entries available in window
+def FillFIFO(sid, n):
+    global FIFO, FIFO_TS, FIFO_RD, FIFO_SCALED
+
+    avail = len(FIFO[sid]) - FIFO_RD[sid]
+
+    if avail < n and READER[sid] is not None and not READER[sid].eof:
+        # Discard entries already read and read ahead
+        rd = FIFO_RD[sid]
+        FIFO[sid]        = FIFO[sid][rd:]
+        FIFO_TS[sid]     = FIFO_TS[sid][rd:]
+        FIFO_RD[sid]     = 0
+        FIFO_SCALED[sid] = None
+
+        while avail < n and not READER[sid].eof:
+            READER[sid].read(n - avail + READ_AHEAD, FIFO[sid], FIFO_TS[sid])
+            avail = len(FIFO[sid])
+
+    return avail
+
+## Get offset of first column of binary file
+# Columns follow file header and sensor descriptors (8-byte aligned)
+#  @param num number of sensors
+#  @return offset of first column
+def binColumnOffset(num):
+    return (BIN_HEADER.size + num * BIN_SENSOR.size + 7) & ~7
+
+## Write file header and sensor descriptors of binary file
+#  @param f file opened for writing (binary), positioned at file start
+#  @param sensors list of sensor descriptors (sid, entries, scale, odr, cnt)
+def writeBinHeader(f, sensors):
+    start  = binColumnOffset(len(sensors))
+    offset = start
+
+    f.write(BIN_HEADER.pack(BIN_MAGIC, BIN_VERSION, len(sensors)))
+
+    for sid, entries, scale, odr, cnt in sensors:
+        f.write(BIN_SENSOR.pack(sid, entries, 0, UNIT[sid].encode(), scale, odr,
+                                cnt, offset, offset + cnt * 8))
+        offset += cnt * 16
+
+    f.write(bytes(start - f.tell()))
+
+## Write column of binary file (little-endian)
+#  @param f file opened for writing (binary)
+#  @param column array of timestamps or values
+def writeBinColumn(f, column):
+    if sys.byteorder != "little":
+        column = array(column.typecode, column)
+        column.byteswap()
+    f.write(column.tobytes())
+
+## Write binary file containing sensor data
+#  @param f file opened for writing (binary)
+#  @param sensors list of sensor columns (sid, entries, scale, odr, ts, val)
+def writeBinFile(f, sensors):
+
+    writeBinHeader(f, [(sid, entries, scale, odr, len(val))
+                       for sid, entries, scale, odr, ts, val in sensors])
+
+    for sid, entries, scale, odr, ts, val in sensors:
+        writeBinColumn(f, ts)
+        writeBinColumn(f, val)
+
+## Open binary file containing sensor data
+# File is memory mapped, FIFOs are views of timestamp and value columns.
+#  @param file_name data file name
+#  @param sids list of sensor ids to load from file
+def openBinFile(file_name, sids):
+    global READER, FIFO, FIFO_TS, SCALE, ODR, UNIT
+    log.info("openBinFile({}) called".format(file_name))
+
+    compressed = Decompressor(file_name) is not None
+
+    if compressed:
+        # Read file header and sensor descriptors, columns are streamed
+        with openFile(file_name, "rb") as f:
+            mm  = f.read(BIN_HEADER.size)
+            mm += f.read(BIN_HEADER.unpack_from(mm, 0)[2] * BIN_SENSOR.size)
+    else:
+        with open(file_name, "rb") as f:
+            mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+    magic, version, num = BIN_HEADER.unpack_from(mm, 0)
+
+    if version != BIN_VERSION:
+        log.error("Unsupported binary format version {}".format(version))
+        return
+
+    data = memoryview(mm)
+
+    for i in range(num):
+        sid, entries, _, unit, scale, odr, cnt, ts_ofs, val_ofs = \
+            BIN_SENSOR.unpack_from(mm, BIN_HEADER.size + i * BIN_SENSOR.size)
+
+        if sid not in sids:
+            continue
+
+        if compressed:
+            READER[sid] = openWindow(BinReader(file_name, cnt, ts_ofs, val_ofs))
+        else:
+            FIFO_TS[sid] = data[ts_ofs  : ts_ofs  + cnt * 8].cast('q')
+            FIFO[sid]    = data[val_ofs : val_ofs + cnt * 8].cast('d')
+
+            # Limit columns to playback window
+            lo = bisect_left(FIFO_TS[sid], window_start)
+            hi = bisect_right(FIFO_TS[sid], window_end) if window_end != 0 else cnt
+            FIFO_TS[sid] = FIFO_TS[sid][lo : max(lo, hi)]
+            FIFO[sid]    = FIFO[sid][lo : max(lo, hi)]
+        DATA_TS[sid] = 1
+
+        UNIT[sid] = unit.rstrip(b"\0").decode()
+        if scale != 0:
+            SCALE[sid] = scale
+        ODR[sid] = odr
+        REC_ODR[sid] = odr
+        if FillFIFO(sid, 1) > 0:
+            RS_T[sid] = FIFO_TS[sid][0]
+
+        log.debug("SID={}: {} entries, unit={}, scale={}, ODR={}".format(sid, cnt, UNIT[sid], scale, odr))
+
+## Wrap data file reader into playback window reader (when window is set)
+#  @param reader data file reader
+#  @return reader
+def openWindow(reader):
+    if window_start == 0 and window_end == 0:
+        return reader
+    return WindowReader(reader)
+
+## Remove file written partly (nothing when it does not exist)
+#  @param file_name file name
+def removeFile(file_name):
+    try:
+        os.remove(file_name)
+    except OSError:
+        pass
+
+## Create timestamp index of CSV data file
+# Index entries are placed every INDEX_STRIDE lines, at lines whose timestamp
+# is greater than the timestamp of the previous line (all FIFO entries of
+# earlier lines have smaller timestamps).
+#  @param file_name data file name
+#  @param ts_col column number of timestamp
+#  @return list of index entries (timestamp, line offset)
+def createIndex(file_name, ts_col):
+    entries = list()
+
+    with openFile(file_name, "rb") as f:
+        offset = len(f.readline())
+        prev   = None
+        line_n = 0
+        for line in f:
+            item = line.split(b",")[ts_col].strip()
+            if item != b"":
+                t = int(item)
+                if line_n >= INDEX_STRIDE and prev is not None and t > prev:
+                    entries.append((t, offset))
+                    line_n = 0
+                prev = t
+            offset += len(line)
+            line_n += 1
+
+    return entries
+
+## Get offset of CSV data file line to start reading at window_start
+# Timestamp index is loaded from <data file>.idx, or created and stored when
+# missing or out of date.
+#  @param file_name data file name
+#  @param ts_col column number of timestamp
+#  @return line offset (0 = line after header)
+def seekIndex(file_name, ts_col):
+    name = file_name + ".idx"
+    st   = os.stat(file_name)
+
+    entries = None
+    try:
+        with open(name, "rb") as f:
+            data = f.read()
+        magic, version, col, size, mtime, num = INDEX_HEADER.unpack_from(data, 0)
+        if (magic == INDEX_MAGIC) and (version == INDEX_VERSION) and (col == ts_col) and \
+           (size == st.st_size) and (mtime == st.st_mtime_ns):
+            entries = list(INDEX_ENTRY.iter_unpack(data[INDEX_HEADER.size : INDEX_HEADER.size + num * INDEX_ENTRY.size]))
+    except (OSError, struct.error):
+        pass
+
+    if entries is None:
+        log.info("Creating timestamp index {}".format(name))
+        entries = createIndex(file_name, ts_col)
+
+        tmp = "{}.{}.tmp".format(name, os.getpid())
+        try:
+            with open(tmp, "wb") as f:
+                f.write(INDEX_HEADER.pack(INDEX_MAGIC, INDEX_VERSION, ts_col, st.st_size, st.st_mtime_ns, len(entries)))
+                for entry in entries:
+                    f.write(INDEX_ENTRY.pack(*entry))
+            os.replace(tmp, name)
+        except OSError as e:
+            log.warning("Cannot write index {}: {}".format(name, e))
+            removeFile(tmp)
+
+    # Last indexed line at or before window start
+    i = bisect_right(entries, (window_start, float('inf'))) - 1
+    if i < 0:
+        return 0
+    return entries[i][1]
+
+## Open file containing sensor data (binary or CSV format)
+#  @param file_name data file name
+#  @param sids list of sensor ids to load from file (default all sensors)
+#  @param names list of CSV column names of sensor values (single sensor)
+def openDataFile(file_name, sids=None, names=None):
+    global READER, ODR
+    log.info("openDataFile({}) called".format(file_name))
+
+    if sids is None:
+        sids = range(SENSOR_COUNT)
+
+    try:
+        f = openFile(file_name, "rb")
+    except OSError:
+        # No recording for this file, sensors stay unavailable
+        log.warning("Sensor data file {} not found".format(file_name))
+        return
+
+    # Detect binary format from file header
+    magic = f.read(len(BIN_MAGIC))
+    f.close()
+
+    if magic == BIN_MAGIC:
+        openBinFile(file_name, sids)
+        return
+
+    f = openFile(file_name, "rt")
 
     # Read file header and determine column numbers for particular sensor value
     components = f.readline().split(",")
-    
+    f.close()
+
     # Keep characters only (remove white spaces, newline, ...)
     for i in range(len(components)):
         components[i] = components[i].strip()
 
     # Display CSV file header
-    logging.debug("Header: {}".format(components))
+    log.debug("Header: {}".format(components))
 
-    # Update key values according to the input file format
-    for k, v in CSV_Col.items():
+    # Determine column numbers according to the input file format
+    col = dict(CSV_Col)
+    for k in names or []:
+        col.setdefault(k, -1)
+    for k, v in col.items():
         for i in range(len(components)):
             if k == components[i]:
-                CSV_Col.update({k : i})
+                col.update({k : i})
                 break
 
-    # CSV_Col now contains updated column number for particular sensor value
+    # col now contains column number for particular sensor value
     # Value -1 means that sensor data is not present
-    #logging.debug("{}".format(CSV_Col))
-
-    # Read line by line and parse data into FIFOs
-    for line in f:
-        data = line.split(",")
-
-        # Keep characters only (remove white spaces, newline, ...)
-        for i in range(len(data)):
-            data[i] = data[i].strip()
-        
-        #logging.debug("Data: {}".format(data))
-
-        if CSV_Col['Timestamp'] != -1:
-            Ts = data[CSV_Col['Timestamp']]
-        else:
-            Ts = ""
-
-        # Fill up the FIFOs
-        if CSV_Col['Temp'] != -1 and data[CSV_Col['Temp']] != "":
-            FIFO[SID_TEMP].append(data[CSV_Col['Temp']])
-            FIFO_TS[SID_TEMP].append(Ts)
-        if CSV_Col['Hum'] != -1 and data[CSV_Col['Hum']] != "":
-            FIFO[SID_HUM].append(data[CSV_Col['Hum']])
-            FIFO_TS[SID_HUM].append(Ts)
-        if CSV_Col['Press'] != -1 and data[CSV_Col['Press']] != "":
-            FIFO[SID_PRESS].append(data[CSV_Col['Press']])
-            FIFO_TS[SID_PRESS].append(Ts)
-        if CSV_Col['AccX'] != -1 and data[CSV_Col['AccX']] != "":
-            FIFO[SID_ACC].append(data[CSV_Col['AccX']])
-            FIFO_TS[SID_ACC].append(Ts)
-        if CSV_Col['AccY'] != -1 and data[CSV_Col['AccY']] != "":
-            FIFO[SID_ACC].append(data[CSV_Col['AccY']])
-            FIFO_TS[SID_ACC].append(Ts)
-        if CSV_Col['AccZ'] != -1 and data[CSV_Col['AccZ']] != "":
-            FIFO[SID_ACC].append(data[CSV_Col['AccZ']])
-            FIFO_TS[SID_ACC].append(Ts)
-        if CSV_Col['GyroX'] != -1 and data[CSV_Col['GyroX']] != "":
-            FIFO[SID_GYRO].append(data[CSV_Col['GyroX']])
-            FIFO_TS[SID_GYRO].append(Ts)
-        if CSV_Col['GyroY'] != -1 and data[CSV_Col['GyroY']] != "":
-            FIFO[SID_GYRO].append(data[CSV_Col['GyroY']])
-            FIFO_TS[SID_GYRO].append(Ts)
-        if CSV_Col['GyroZ'] != -1 and data[CSV_Col['GyroZ']] != "":
-            FIFO[SID_GYRO].append(data[CSV_Col['GyroZ']])
-            FIFO_TS[SID_GYRO].append(Ts)
-        if CSV_Col['MagX'] != -1 and data[CSV_Col['MagX']] != "":
-            FIFO[SID_MAG].append(data[CSV_Col['MagX']])
-            FIFO_TS[SID_MAG].append(Ts)
-        if CSV_Col['MagY'] != -1 and data[CSV_Col['MagY']] != "":
-            FIFO[SID_MAG].append(data[CSV_Col['MagY']])
-            FIFO_TS[SID_MAG].append(Ts)
-        if CSV_Col['MagZ'] != -1 and data[CSV_Col['MagZ']] != "":
-            FIFO[SID_MAG].append(data[CSV_Col['MagZ']])
-            FIFO_TS[SID_MAG].append(Ts)
-
-    f.close()
+    #log.debug("{}".format(col))
+
+    # Position readers near playback window start
+    offset = 0
+    if window_start != 0 and col['Timestamp'] != -1:
+        offset = seekIndex(file_name, col['Timestamp'])
+
+    # Create data file readers (sensor samples are read on demand)
+    for sid in sids:
+        cols = [col[k] for k in (names or CSV_Sensor_Cols[sid]) if col[k] != -1]
+        if len(cols) > 0:
+            READER[sid] = openWindow(CSVReader(file_name, cols, col['Timestamp'], offset))
+
+    if col['Timestamp'] != -1:
+        # Timestamp is provided, initial ODR is determined from the recording
+        # when it is first needed (see DetectODR)
+        for sid in sids:
+            DATA_TS[sid] = 1
+
+## Get content hash of data file
+#  @param file_name data file name
+#  @return hash digest (32 bytes)
+def HashFile(file_name):
+    h = hashlib.blake2b(digest_size=32)
+
+    with open(file_name, "rb") as f:
+        for block in iter(lambda: f.read(1 << 20), b""):
+            h.update(block)
+
+    return h.digest()
+
+## Parse sensor values of data file lines
+#  @param lines iterable of data file lines
+#  @param cols_list list of column numbers of sensor values (per sensor)
+#  @param ts_col column number of timestamp (-1 = not present)
+#  @return list of (ts, val) parsed columns (per sensor)
+def parseLines(lines, cols_list, ts_col):
+    columns = [(array('q'), array('d')) for cols in cols_list]
+    sensors = [(cols, val, ts) for cols, (ts, val) in zip(cols_list, columns)]
+
+    for line in lines:
+        parseLineSensors(line, sensors, ts_col)
+
+    return columns
+
+## Parse sensor values of a data file chunk (runs in worker process)
+#  @param chunk (file name, start offset, end offset, columns per sensor,
+#         timestamp column)
+#  @return list of (ts, val) parsed timestamps and values (bytes, per sensor)
+def parseChunk(chunk):
+    file_name, start, end, cols_list, ts_col = chunk
+
+    with open(file_name, "rb") as f:
+        f.seek(start)
+        data = f.read(end - start)
+
+    # Decode the same way as data file opened in text mode
+    columns = parseLines(io.TextIOWrapper(io.BytesIO(data)), cols_list, ts_col)
+
+    return [(ts.tobytes(), val.tobytes()) for ts, val in columns]
+
+## Parse sensor columns of complete data file in chunks
+# All sensors are parsed in a single pass over the file. Large files are
+# split at line boundaries and the chunks are parsed by a process pool when
+# parse_workers allows it, otherwise the file is read serially. Chunks are
+# produced in file (timestamp) order.
+#  @param file_name data file name
+#  @param cols_list list of column numbers of sensor values (per sensor)
+#  @param ts_col column number of timestamp (-1 = not present)
+#  @return iterator of parsed chunks, list of (ts, val) per sensor
+def parseChunks(file_name, cols_list, ts_col):
+    workers = parse_workers or os.cpu_count() or 1
+    size    = os.path.getsize(file_name)
+
+    if workers > 1 and size > 2 * PARSE_CHUNK and Decompressor(file_name) is None:
+        chunks = list()
+
+        with open(file_name, "rb") as f:
+            f.readline()
+            start = f.tell()
+            while start < size:
+                # Chunk ends at the end of line following chunk size
+                f.seek(start + PARSE_CHUNK)
+                f.readline()
+                end = min(f.tell(), size)
+                chunks.append((file_name, start, end, cols_list, ts_col))
+                start = end
+
+        done = 0
+        try:
+            with concurrent.futures.ProcessPoolExecutor(min(workers, len(chunks))) as pool:
+                for result in pool.map(parseChunk, chunks):
+                    yield [(array('q', ts), array('d', val)) for ts, val in result]
+                    done += 1
+            return
+        except Exception as e:
+            if done != 0:
+                raise
+            # Process pool not usable (e.g. embedded interpreter), parse serially
+            log.warning("Parallel parsing of {} failed ({}), parsing serially".format(file_name, e))
+
+    with openFile(file_name, "rt") as f:
+        f.readline()
+        while True:
+            lines = f.readlines(PARSE_LINES)
+            if len(lines) == 0:
+                break
+            yield parseLines(lines, cols_list, ts_col)
+
+## Parse sensor columns of complete data file
+#  @param file_name data file name
+#  @param cols_list list of column numbers of sensor values (per sensor)
+#  @param ts_col column number of timestamp (-1 = not present)
+#  @return list of (ts, val) parsed columns (per sensor)
+def parseColumns(file_name, cols_list, ts_col):
+    columns = [(array('q'), array('d')) for cols in cols_list]
+
+    for chunk in parseChunks(file_name, cols_list, ts_col):
+        for (ts, val), (ts_chunk, val_chunk) in zip(columns, chunk):
+            ts.extend(ts_chunk)
+            val.extend(val_chunk)
+
+    return columns
+
+## Read parsed data cache of a sensor
+# Cache is valid when data file size and content match the cache key, the
+# content is hashed only when the modification time changed (e.g. fresh
+# checkout of the same recording).
+#  @param sid sensor id
+#  @param r CSV reader of the sensor
+#  @param cols hash of column numbers
+#  @return (ts, val) cached columns or None when cache is missing or stale
+def readCache(sid, r, cols):
+    name = "{}.{}.cache".format(r.name, SENSOR_NAME[sid])
+
+    try:
+        with open(name, "rb") as f:
+            mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    except (OSError, ValueError):
+        return None
+
+    if len(mm) < BIN_HEADER.size + BIN_SENSOR.size + CACHE_KEY.size:
+        return None
+
+    magic, version, num = BIN_HEADER.unpack_from(mm, 0)
+    key_magic, size, mtime, key_cols, digest = CACHE_KEY.unpack_from(mm, len(mm) - CACHE_KEY.size)
+
+    if (magic != BIN_MAGIC) or (version != BIN_VERSION) or (num != 1) or \
+       (key_magic != CACHE_MAGIC) or (key_cols != cols):
+        return None
+
+    st = os.stat(r.name)
+    if size != st.st_size:
+        return None
+
+    if mtime != st.st_mtime_ns:
+        if digest != HashFile(r.name):
+            return None
+        # Same content, refresh modification time in cache key
+        with open(name, "r+b") as f:
+            f.seek(-CACHE_KEY.size, os.SEEK_END)
+            f.write(CACHE_KEY.pack(CACHE_MAGIC, size, st.st_mtime_ns, cols, digest))
+
+    _, _, _, _, _, _, cnt, ts_ofs, val_ofs = BIN_SENSOR.unpack_from(mm, BIN_HEADER.size)
+
+    data = memoryview(mm)
+    return (data[ts_ofs  : ts_ofs  + cnt * 8].cast('q'),
+            data[val_ofs : val_ofs + cnt * 8].cast('d'))
+
+## Parse sensor columns of data file and write parsed data cache
+# Parsed chunks are written as they are produced (values through a temporary
+# file), so the complete columns are never held in memory.
+#  @param sid sensor id
+#  @param r CSV reader of the sensor
+#  @param cols hash of column numbers
+#  @param columns (ts, val) complete columns already read (None = parse)
+#  @return True when cache is written
+def writeCache(sid, r, cols, columns=None):
+    name = "{}.{}.cache".format(r.name, SENSOR_NAME[sid])
+    st   = os.stat(r.name)
+
+    if columns is None:
+        chunks = (chunk[0] for chunk in parseChunks(r.name, [r.cols], r.ts_col))
+    else:
+        chunks = [columns]
+
+    entries = Entries(sid)
+
+    # Write to temporary file first, runs started in parallel may share cache
+    tmp = "{}.{}.tmp".format(name, os.getpid())
+    try:
+        with open(tmp, "wb") as f, tempfile.TemporaryFile() as f_val:
+            # Header is written when the number of entries is known
+            f.seek(binColumnOffset(1))
+
+            cnt = 0
+            for ts, val in chunks:
+                writeBinColumn(f, ts)
+                writeBinColumn(f_val, val)
+                cnt += len(val)
+
+            f_val.seek(0)
+            shutil.copyfileobj(f_val, f)
+            f.write(CACHE_KEY.pack(CACHE_MAGIC, st.st_size, st.st_mtime_ns, cols, HashFile(r.name)))
+
+            f.seek(0)
+            writeBinHeader(f, [(sid, entries, 0, REC_ODR[sid], cnt)])
+        os.replace(tmp, name)
+    except OSError as e:
+        log.warning("Cannot write cache {}: {}".format(name, e))
+        removeFile(tmp)
+        return False
+
+    return True
+
+## Load parsed columns of a sensor from cache
+# Sensor data file is parsed completely once, only for sensors firmware
+# enables. Reading continues from cached columns at the current position,
+# or from the data file when the cache cannot be written.
+# Reader that already consumed its whole column only writes the cache.
+#  @param sid sensor id
+#  @param parse parse data file when cache is missing or stale (sensor is
+#         enabled), otherwise use existing cache only
+def loadCache(sid, parse=True):
+    global READER
+
+    w = READER[sid]
+    r = w.reader if type(w) is WindowReader else w
+    if not cache or type(r) is not CSVReader:
+        return
+
+    cols = hashlib.blake2b(repr((r.cols, r.ts_col)).encode(), digest_size=16).digest()
+
+    if r.eof:
+        if parse and readCache(sid, r, cols) is None:
+            if w is r and r.offset == 0 and FIFO_RD[sid] == 0 and len(FIFO[sid]) == r.count:
+                # Complete column is still in FIFO window
+                writeCache(sid, r, cols, (FIFO_TS[sid], FIFO[sid]))
+            else:
+                writeCache(sid, r, cols)
+        return
+
+    columns = readCache(sid, r, cols)
+    if columns is None:
+        if not parse:
+            return
+        SLOG[sid].info("Parsing {} into cache".format(r.name))
+
+        # Map the written cache, so memory stays bounded as on runs with a
+        # valid cache (keep reading data file when cache cannot be written)
+        if writeCache(sid, r, cols):
+            columns = readCache(sid, r, cols)
+        if columns is None:
+            return
+
+    # Continue at the entry following the last one read from data file
+    if r.count == 0:
+        # Nothing read yet, start at the line the reader is positioned at
+        pos = bisect_left(columns[0], window_start) if r.offset != 0 else 0
+    else:
+        pos = r.count
+        if r.offset != 0:
+            pos += bisect_left(columns[0], r.first_ts)
 
-    if CSV_Col['Timestamp'] != -1:
-        # Timestamp is provided, determine initial ODR
-        for sid in range(SENSOR_COUNT):
-            if len(FIFO_TS[sid]) > 0:
-                if (sid == SID_TEMP) or (sid == SID_HUM) or (sid == SID_PRESS):                
-                    t0 = FIFO_TS[sid][0]
-                    t1 = FIFO_TS[sid][1]
-                else:
-                    t0 = FIFO_TS[sid][0]
-                    t1 = FIFO_TS[sid][3]
+    r.f.close()
+    if w is r:
+        READER[sid] = ColumnReader(columns[0], columns[1], pos)
+    else:
+        w.reader = ColumnReader(columns[0], columns[1], pos)
 
-            ODR[sid] = int(t1) - int(t0)
+## Check whether recorded samples of a sensor are available
+#  @param sid sensor id
+#  @return True when sensor data is present in data file
+def IsDataAvailable(sid):
+    return READER[sid] is not None or len(FIFO[sid]) > 0
 
 def enTEMP(enable):
-    if enable and CSV_Col['Temp'] == -1:
+    if enable and not IsDataAvailable(SID_TEMP):
         # Sensor samples not available
         enable = 0
 
     return enable
 
 def enHUM(enable):
-    if enable and CSV_Col['Hum'] == -1:
+    if enable and not IsDataAvailable(SID_HUM):
         # Sensor samples not available
         enable = 0
 
     return enable
 
 def enPRESS(enable):
-    if enable and CSV_Col['Press'] == -1:
+    if enable and not IsDataAvailable(SID_PRESS):
         # Sensor samples not available
         enable = 0
 
     return enable
 
 def enACC(enable):
-    if enable and (CSV_Col['AccX'] == -1 and CSV_Col['AccY'] == -1 and CSV_Col['AccZ'] == -1):
+    if enable and not IsDataAvailable(SID_ACC):
         # Sensor samples not available
         enable = 0
 
     return enable
 
 def enGYRO(enable):
-    if enable and (CSV_Col['GyroX'] == -1 and CSV_Col['GyroY'] == -1 and CSV_Col['GyroZ'] == -1):
+    if enable and not IsDataAvailable(SID_GYRO):
         # Sensor samples not available
         enable = 0
 
     return enable
 
 def enMAG(enable):
-    if enable and (CSV_Col['MagX'] == -1 and CSV_Col['MagY'] == -1 and CSV_Col['MagZ'] == -1):
+    if enable and not IsDataAvailable(SID_MAG):
         # Sensor samples not available
         enable = 0
 
     return enable
 
-# Handle Timer Interval Expiration
-def IntervalHandler():
-    global ODR_CNT, FIFO_CNT
-    logging.debug("IntervalHandler() called")
+## Check whether samples of a sensor are produced at recorded timestamps
+#  @param sid sensor id
+#  @return True for timestamp playback
+def IsPlaybackTs(sid):
+    return PLAYBACK[sid] == PLAYBACK_TIMESTAMP and DATA_TS[sid]
+
+## Get virtual time when a FIFO entry is produced (timestamp playback)
+#  @param sid sensor id
+#  @param n FIFO entry index (relative to FIFO read cursor)
+#  @return virtual time (in microseconds), None when not in recording
+def ArrivalTime(sid, n):
+
+    if FillFIFO(sid, n + 1) <= n:
+        return None
+
+    return ODR_T0[sid] + FIFO_TS[sid][FIFO_RD[sid] + n] - TS_T0[sid]
+
+## Update FIFO of a sensor to the current virtual time
+# Samples are not counted on each timer event. Number of samples produced
+# since ODR_T0 is calculated (exact integer arithmetic) only when FIFO state
+# is needed, i.e. when FIFO_CNT, FIFO, FIFO_TS, STATUS or INTERVAL is read.
+# With timestamp playback, FIFO entries whose recorded timestamp (relative to
+# sampling start) has passed are counted.
+#  @param sid sensor id
+def UpdateFIFO(sid):
+    global ODR_CNT, FIFO_CNT, FIFO_T0
+
+    if not ENABLE[sid] or sid == STREAM_SID:
+        return
+
+    if IsPlaybackTs(sid):
+        t0 = ArrivalTime(sid, FIFO_CNT[sid])
+
+        if t0 is None or t0 > Timer_Time:
+            return
+
+        if FIFO_CNT[sid] == 0:
+            # Oldest sample in FIFO arrived at its recorded time
+            FIFO_T0[sid] = t0
+
+        # Find first FIFO entry not produced yet (refill window as needed)
+        limit = Timer_Time - ODR_T0[sid] + TS_T0[sid]
+        n     = FIFO_CNT[sid]
+        while True:
+            rd = FIFO_RD[sid]
+            n  = bisect_right(FIFO_TS[sid], limit, rd + n, len(FIFO_TS[sid])) - rd
+            if rd + n < len(FIFO_TS[sid]) or FillFIFO(sid, n + 1) <= n:
+                break
 
-    for sid in range(SENSOR_COUNT):
-        if ENABLE[sid]:
-            # Sensor is enabled, check its interval counter
-            if ODR_CNT[sid] > 0:
-                # Decrease interval down-counter
-                ODR_CNT[sid] -= INTERVAL
-            
-            if ODR_CNT[sid] == 0:
-                # Increase number of samples in FIFO
-                FIFO_CNT[sid] += int(INTERVAL / ODR[sid])
-
-                if sid >= SID_ACC:
-                    # Motion sensor sample consists of 3 FIFO entries
-                    FIFO_CNT[sid] *= 3
-
-                # Interval expired, reload down-counter
-                ODR_CNT[sid] = ODR[sid]
-            
-            logging.debug("SID={}, ODR_CNT={}. FIFO_CNT={}".format(sid, ODR_CNT[sid], FIFO_CNT[sid]))
-
-## Calculate the timer overflow interval to service enabled sensors
-# Function calculates greatest common divisor among ODR registers
+        FIFO_CNT[sid] = n
+        CheckOverrun(sid)
+        return
+
+    if ODR[sid] <= 0:
+        return
+
+    num = (Timer_Time - ODR_T0[sid]) // ODR[sid] - ODR_CNT[sid]
+
+    if num > 0:
+        if FIFO_CNT[sid] == 0:
+            # Oldest sample in FIFO arrived at first expired interval
+            FIFO_T0[sid] = ODR_T0[sid] + (ODR_CNT[sid] + 1) * ODR[sid]
+
+        ODR_CNT[sid] += num
+
+        num *= Entries(sid)
+
+        # Increase number of samples in FIFO (limited by recorded samples)
+        if IsResampling(sid):
+            avail = ResampleCount(sid, FIFO_CNT[sid] + num)
+        else:
+            avail = FillFIFO(sid, FIFO_CNT[sid] + num)
+        FIFO_CNT[sid] = min(FIFO_CNT[sid] + num, avail)
+        CheckOverrun(sid)
+
+## Discard FIFO entries of a sensor following the oldest ones (FIFO window)
+#  @param sid sensor id
+#  @param pos index of first entry to discard (relative to FIFO read cursor)
+#  @param n number of entries to discard
+def DropFIFO(sid, pos, n):
+    global READER, FIFO, FIFO_TS, FIFO_RD, FIFO_SCALED
+
+    rd = FIFO_RD[sid]
+
+    if type(FIFO[sid]) is memoryview:
+        # Memory mapped columns are read only, keep entries before pos in
+        # window and continue reading columns after discarded entries
+        READER[sid]  = ColumnReader(FIFO_TS[sid], FIFO[sid], rd + pos + n)
+        FIFO[sid]    = array('d', FIFO[sid][rd : rd + pos])
+        FIFO_TS[sid] = array('q', FIFO_TS[sid][rd : rd + pos])
+        FIFO_RD[sid] = 0
+    else:
+        del FIFO[sid][rd + pos : rd + pos + n]
+        del FIFO_TS[sid][rd + pos : rd + pos + n]
+
+    FIFO_SCALED[sid] = None
+
+## Limit FIFO of a sensor to its depth (discard samples on overrun)
+# Overrun is handled at sample boundaries only (no partly read sample).
+# Resampled samples are calculated at the read position, so the oldest
+# samples are discarded regardless of overrun policy.
+#  @param sid sensor id
+def CheckOverrun(sid):
+    global FIFO_CNT, FIFO_RD, FIFO_T0, RS_T, OVERRUN, OVERRUN_FLAG
+
+    if FIFO_DEPTH[sid] == 0:
+        return
+
+    entries = Entries(sid)
+
+    if FIFO_CNT[sid] % entries != 0:
+        return
+
+    num = FIFO_CNT[sid] // entries - FIFO_DEPTH[sid]
+    if num <= 0:
+        return
+
+    if OVERRUN_POLICY[sid] == OVERRUN_DROP_NEWEST and not IsResampling(sid):
+        # Samples following the full FIFO are lost
+        DropFIFO(sid, FIFO_DEPTH[sid] * entries, num * entries)
+    else:
+        # Oldest samples are overwritten
+        if IsResampling(sid):
+            RS_T[sid] += num * ODR[sid]
+        else:
+            FIFO_RD[sid] += num * entries
+
+        if IsPlaybackTs(sid):
+            FIFO_T0[sid] = ArrivalTime(sid, 0)
+        else:
+            FIFO_T0[sid] += num * ODR[sid]
+
+    FIFO_CNT[sid]    -= num * entries
+    OVERRUN[sid]     += num
+    OVERRUN_FLAG[sid] = 1
+
+    SLOG[sid].debug("Overrun: %d samples lost", num)
+
+## Get FIFO watermark of a sensor (limited by FIFO depth)
+#  @param sid sensor id
+#  @return number of samples that triggers an interrupt
+def Watermark(sid):
+    value = max(WATERMARK[sid], 1)
+
+    if FIFO_DEPTH[sid] != 0:
+        value = min(value, FIFO_DEPTH[sid])
+
+    return value
+
+## Determine recorded ODR of a sensor around the playback window
+# Used when the playback window holds fewer than two samples of the sensor.
+# Interval is taken from the first samples at or after window start ignoring
+# window end, or from the last samples of the recording.
+#  @param sid sensor id
+#  @return recorded ODR (in microseconds), 0 when not available
+def WindowODR(sid):
+    w = READER[sid]
+    if type(w) is not WindowReader:
+        return 0
+
+    r   = w.reader.reopen()
+    n   = Entries(sid)
+    ts  = array('q')
+    val = array('d')
+
+    while not r.eof:
+        r.read(READ_AHEAD, val, ts)
+
+        k = bisect_left(ts, window_start)
+        if len(ts) > k + n:
+            return ts[k + n] - ts[k]
+
+        # Keep the last sample before window start only
+        del ts[:max(k - n, 0)]
+        del val[:max(k - n, 0)]
+
+    if len(ts) > n:
+        return ts[-1] - ts[-1 - n]
+    return 0
+
+## Determine recorded ODR of a sensor from its first two samples
+# Detection is deferred until the ODR register is read or the sensor is
+# enabled, so data of sensors firmware does not use is not read at init.
+# Samples are taken from the parsed data cache when it is valid.
+# ODR register takes the recorded ODR unless it was configured.
+#  @param sid sensor id
+def DetectODR(sid):
+    global ODR, REC_ODR, RS_T
+
+    if not DATA_TS[sid] or REC_ODR[sid] != 0:
+        return
+
+    # Read first samples from valid cache instead of data file
+    loadCache(sid, False)
+
+    n = Entries(sid)
+
+    avail = FillFIFO(sid, n + 1)
+    if avail > n:
+        t0 = FIFO_TS[sid][FIFO_RD[sid]]
+        t1 = FIFO_TS[sid][FIFO_RD[sid] + n]
+
+        REC_ODR[sid] = t1 - t0
+    else:
+        # Single sample (or none) in playback window
+        REC_ODR[sid] = WindowODR(sid)
+
+    if avail > 0:
+        RS_T[sid] = FIFO_TS[sid][FIFO_RD[sid]]
+    if ODR[sid] == 0:
+        ODR[sid] = REC_ODR[sid]
+
+## Restart sample production of a sensor at the current virtual time
+#  @param sid sensor id
+def RestartODR(sid):
+    global ODR_CNT, ODR_T0, TS_T0
+
+    ODR_T0[sid]  = Timer_Time
+    ODR_CNT[sid] = 0
+
+    if IsPlaybackTs(sid) and FillFIFO(sid, FIFO_CNT[sid] + 1) > FIFO_CNT[sid]:
+        # Next sample is produced now, following samples at recorded times
+        TS_T0[sid] = FIFO_TS[sid][FIFO_RD[sid] + FIFO_CNT[sid]]
+
+## Calculate the timer interval to the next deadline of enabled sensors
+# Deadline of a sensor is the time when its FIFO reaches the watermark or
+# when its oldest sample reaches the latency limit, whichever comes first.
+# Timer therefore expires only when an interrupt is actually required
+# instead of ticking at the greatest common divisor of all ODRs. This is the
+# only place where the deadline rule is evaluated.
+# The driver re-arms the timer in its interrupt handler before the
+# application drains the FIFO. Samples that already reached the watermark or
+# the latency limit are reported by the current interrupt, so the next
+# deadline is based on samples produced from now on (a full watermark).
+#  @return value time to the next deadline (in microseconds), 0 if none
 def CalculateInterval():
-    odr = list()
-    
+    value = 0
+
     for sid in range(SENSOR_COUNT):
-        if ODR[sid] > 0:
-            odr.append(ODR[sid])
+        if not ENABLE[sid] or sid == STREAM_SID:
+            continue
+
+        if not IsPlaybackTs(sid) and ODR[sid] <= 0:
+            continue
+
+        UpdateFIFO(sid)
+
+        entries = Entries(sid)
+
+        # Number of samples in FIFO not reported by an interrupt yet
+        pending = FIFO_CNT[sid] // entries
+        if pending >= Watermark(sid):
+            pending = 0
+        if LATENCY > 0 and pending > 0 and FIFO_T0[sid] + LATENCY <= Timer_Time:
+            pending = 0
+
+        # Number of new samples for FIFO to reach the watermark
+        need = Watermark(sid) - pending
+
+        if IsPlaybackTs(sid):
+            # Time to the next sample and to the watermark at recorded times
+            t_next = ArrivalTime(sid, FIFO_CNT[sid])
+            if t_next is None:
+                # Recording exhausted
+                continue
+            t_next -= Timer_Time
+
+            t = ArrivalTime(sid, FIFO_CNT[sid] + need * entries - 1)
+            if t is None:
+                t = t_next
+            else:
+                t -= Timer_Time
+        else:
+            # Time to the next sample and to the watermark
+            t_next = ODR_T0[sid] + (ODR_CNT[sid] + 1) * ODR[sid] - Timer_Time
+            t = t_next + (need - 1) * ODR[sid]
 
-    i = 1
-    while i < len(odr): 
-        odr[0] = math.gcd(odr[0], odr[i])
-        i += 1
+        if LATENCY > 0:
+            if pending > 0:
+                t_lat = FIFO_T0[sid] + LATENCY - Timer_Time
+            else:
+                t_lat = t_next + LATENCY
+            t = min(t, t_lat)
 
-    value = odr[0]
+        if value == 0 or t < value:
+            value = t
 
     return value
 
+# REGISTER TRACE
+# ==============
+# Trace file: header (magic, version, VSI instance, number of records)
+# followed by fixed-size records (virtual time in microseconds, register
+# index, access direction, register value), oldest record first.
+TRACE_MAGIC   = b"VSIT"
+TRACE_VERSION = 1
+TRACE_HEADER  = struct.Struct("<4sHHI")
+TRACE_RECORD  = struct.Struct("<QHBxI")
+
+# Access direction
+TRACE_RD = 0
+TRACE_WR = 1
+
+# Trace ring buffer (None = trace off) and number of records traced
+TRACE_BUF = None
+TRACE_CNT = 0
+
+## Append register access record to trace ring buffer
+#  @param direction access direction (TRACE_RD or TRACE_WR)
+#  @param index user register index
+#  @param value register value (32-bit)
+def Trace(direction, index, value):
+    global TRACE_CNT
+
+    ofs = (TRACE_CNT % trace) * TRACE_RECORD.size
+    TRACE_RECORD.pack_into(TRACE_BUF, ofs, Timer_Time, index, direction, value & 0xffffffff)
+    TRACE_CNT += 1
+
+## Write trace ring buffer to trace file (called at exit)
+def dumpTrace():
+    num = min(TRACE_CNT, trace)
+    pos = (TRACE_CNT % trace) * TRACE_RECORD.size
+
+    with open(FILE_NAME_TRACE, "wb") as f:
+        f.write(TRACE_HEADER.pack(TRACE_MAGIC, TRACE_VERSION, INSTANCE, num))
+        if TRACE_CNT >= trace:
+            # Ring buffer wrapped, oldest record is at write position
+            f.write(TRACE_BUF[pos:])
+            f.write(TRACE_BUF[:pos])
+        else:
+            f.write(TRACE_BUF[:pos])
+
+## Start register access trace (when enabled)
+def startTrace():
+    global TRACE_BUF
+
+    if trace > 0:
+        TRACE_BUF = bytearray(trace * TRACE_RECORD.size)
+        atexit.register(dumpTrace)
+        log.info("Register trace enabled ({} records)".format(trace))
+
 # USER REGISTER HANDLING
 # ======================
 
 ## Read ENABLE register (user register)
+#  @param sid sensor id
 #  @return value value read (32-bit)
-def rdENABLE():
-    global SELECT, ENABLE
+def rdENABLE(sid):
+    global ENABLE
 
-    sid = SELECT
     value = ENABLE[sid]
 
-    logging.debug("Read ENABLE[{}]: {}".format(sid, value))
+    SLOG[sid].debug("Read ENABLE[%d]: %d", sid, value)
     return value
 
 ## Write ENABLE register (user register)
+#  @param sid sensor id
 #  @param value value to write (32-bit)
-def wrENABLE(value):
-    global SELECT, ENABLE
-
-    sid = SELECT
+def wrENABLE(sid, value):
+    global ENABLE
 
     if   sid == SID_TEMP:
         value = enTEMP(value)
@@ -378,7 +1841,18 @@ def wrENABLE(value):
     elif sid == SID_MAG:
         value = enMAG(value)
 
-    logging.debug("Write ENABLE[{}] = {}".format(sid, value))
+    SLOG[sid].debug("Write ENABLE[%d] = %d", sid, value)
+
+    if value and not ENABLE[sid]:
+        # Sampling starts now
+        loadCache(sid)
+        DetectODR(sid)
+        RestartODR(sid)
+        OVERRUN[sid]      = 0
+        OVERRUN_FLAG[sid] = 0
+    else:
+        # Account samples produced until now
+        UpdateFIFO(sid)
 
     ENABLE[sid] = value
 
@@ -390,12 +1864,18 @@ def rdSTATUS():
     value = 0
 
     for sid in range(SENSOR_COUNT):
+        UpdateFIFO(sid)
+
         if FIFO_CNT[sid] > 0:
             value |= 1 << sid
 
+        if OVERRUN_FLAG[sid]:
+            value |= 1 << (8 + sid)
+            OVERRUN_FLAG[sid] = 0
+
     STATUS = value
 
-    logging.debug("Read STATUS: {}".format(value))
+    log.debug("Read STATUS: %d", value)
     return value
 
 ## Read INTERVAL register (user register)
@@ -403,123 +1883,671 @@ def rdSTATUS():
 def rdINTERVAL():
     global INTERVAL
 
+    INTERVAL = CalculateInterval()
     value = INTERVAL
 
-    logging.debug("Read INTERVAL: {}".format(value))
+    log.debug("Read INTERVAL: %d", value)
     return value
 
-## Read SELECT register (user register)
-#  @return value value read (32-bit)
-def rdSELECT(value):
-    global SELECT
-
-    value = SELECT
-
-    logging.debug("Read SELECT: {}".format(value))
-    return value
-
-## Write SELECT register (user register)
-#  @param value value to write (32-bit)
-def wrSELECT(value):
-    global SELECT
-    logging.debug("Write SELECT = {}".format(value))
-
-    SELECT = value
-
 ## Read SCALE register (user register)
+#  @param sid sensor id
 #  @return value value read (32-bit)
-def rdSCALE():
-    global SELECT, SCALE
+def rdSCALE(sid):
+    global SCALE
 
-    sid = SELECT
     value = SCALE[sid]
 
-    logging.debug("Read SCALE[{}]: {}".format(sid, value))
+    SLOG[sid].debug("Read SCALE[%d]: %d", sid, value)
     return value
 
 ## Write SCALE register (user register)
+#  @param sid sensor id
 #  @param value value to write (32-bit)
-def wrSCALE(value):
-    global SELECT, SCALE
+def wrSCALE(sid, value):
+    global SCALE
+
+    SLOG[sid].debug("Write SCALE[%d] = %d", sid, value)
 
-    sid = SELECT
-    logging.debug("Write SCALE[{}] = {}".format(sid, value))
+    if SCALE[sid] != value:
+        # Scaled sample values are no longer valid
+        FIFO_SCALED[sid] = None
 
     SCALE[sid] = value
 
 ## Read ODR register (user register)
+#  @param sid sensor id
 #  @return value value read (32-bit)
-def rdODR():
-    global SELECT, ODR
+def rdODR(sid):
+    global ODR
+
+    DetectODR(sid)
 
-    sid = SELECT
     value = ODR[sid]
 
-    logging.debug("Read ODR[{}]: {}".format(sid, value))
+    SLOG[sid].debug("Read ODR[%d]: %d", sid, value)
 
     return value
 
 ## Write ODR register (user register)
+#  @param sid sensor id
 #  @param value value to write (32-bit)
-def wrODR(value):
-    global SELECT, ODR
+def wrODR(sid, value):
+    global ODR
+
+    SLOG[sid].debug("Write ODR[%d] = %d", sid, value)
 
-    sid = SELECT
-    logging.debug("Write ODR[{}] = {}".format(sid, value))
+    # Account samples produced at previous interval
+    UpdateFIFO(sid)
+
+    if not IsPlaybackTs(sid):
+        # Keep sample phase (timestamp playback uses recorded sample times)
+        if ODR[sid] > 0:
+            ODR_T0[sid] += ODR_CNT[sid] * ODR[sid]
+        else:
+            ODR_T0[sid]  = Timer_Time
+        ODR_CNT[sid] = 0
 
     ODR[sid] = value
 
 ## Read FIFO_CNT register (user register)
+#  @param sid sensor id
 #  @return value value read (32-bit)
-def rdFIFO_CNT():
-    global SELECT, FIFO_CNT
+def rdFIFO_CNT(sid):
+    global FIFO_CNT
+
+    UpdateFIFO(sid)
 
-    sid = SELECT
     value = FIFO_CNT[sid]
 
-    logging.debug("Read FIFO_CNT[{}]: {}".format(sid, value))
+    SLOG[sid].debug("Read FIFO_CNT[%d]: %d", sid, value)
+    return value
+
+## Get recorded sample value at FIFO read cursor as 32-bit register value
+# Sample values are converted with current SCALE in blocks of READ_AHEAD.
+#  @param sid sensor id
+#  @return value scaled sample value (32-bit)
+def ScaleFIFO(sid):
+    global FIFO_SCALED, FIFO_SCALED_RD
+
+    rd = FIFO_RD[sid]
+    i  = rd - FIFO_SCALED_RD[sid]
+
+    if FIFO_SCALED[sid] is None or i < 0 or i >= len(FIFO_SCALED[sid]):
+        scale = SCALE[sid]
+        FIFO_SCALED[sid]    = array('I', [int(val * scale) & 0xffffffff for val in FIFO[sid][rd : rd + READ_AHEAD]])
+        FIFO_SCALED_RD[sid] = rd
+        i = 0
+
+    return FIFO_SCALED[sid][i]
+
+## Check whether samples of a sensor are resampled to output data rate
+#  @param sid sensor id
+#  @return True when sample values are interpolated at ODR[sid] intervals
+def IsResampling(sid):
+    return RESAMPLE[sid] != RESAMPLE_NONE and DATA_TS[sid] and not IsPlaybackTs(sid)
+
+## Fill FIFO window with recorded samples up to a signal time
+#  @param sid sensor id
+#  @param t signal time (recorded timestamp)
+#  @param entries number of FIFO entries per sample
+#  @return number of recorded samples available in window
+def FillRecorded(sid, t, entries):
+
+    n = (len(FIFO_TS[sid]) - FIFO_RD[sid]) // entries
+
+    while n == 0 or FIFO_TS[sid][FIFO_RD[sid] + (n - 1) * entries] < t:
+        if FillFIFO(sid, (n + 1) * entries) < (n + 1) * entries:
+            # End of recording
+            break
+        n = (len(FIFO_TS[sid]) - FIFO_RD[sid]) // entries
+
+    return n
+
+## Get number of FIFO entries that can be resampled from recording
+#  @param sid sensor id
+#  @param cnt number of FIFO entries requested (from head of FIFO)
+#  @return number of FIFO entries within recorded signal time
+def ResampleCount(sid, cnt):
+
+    entries = Entries(sid)
+
+    t = RS_T[sid] + ((RS_E[sid] + cnt - 1) // entries) * ODR[sid]
+    n = FillRecorded(sid, t, entries)
+
+    if n == 0:
+        return 0
+
+    t_end = FIFO_TS[sid][FIFO_RD[sid] + (n - 1) * entries]
+
+    if t_end >= t:
+        return cnt
+
+    num = (t_end - RS_T[sid]) // ODR[sid] + 1
+
+    return max(num * entries - RS_E[sid], 0)
+
+## Interpolate recorded sample value at signal time
+# Window read cursor is kept at the oldest recorded sample still required.
+# Windowed-sinc interpolation low-pass filters at the lower of recorded and
+# output Nyquist frequency and normalizes the kernel (irregular timestamps).
+#  @param sid sensor id
+#  @param t signal time (recorded timestamp)
+#  @param axis entry index within sample
+#  @return value interpolated sample value, None when beyond recording
+def Resample(sid, t, axis):
+    global FIFO_RD
+
+    entries = Entries(sid)
+
+    T = REC_ODR[sid]
+
+    if RESAMPLE[sid] == RESAMPLE_SINC and T > 0:
+        c     = min(1.0, T / ODR[sid])
+        width = SINC_TAPS * T / c
+    else:
+        width = 0
+
+    n  = FillRecorded(sid, t + width, entries)
+    rd = FIFO_RD[sid]
+    ts = FIFO_TS[sid]
+    x  = FIFO[sid]
+
+    if n == 0 or ts[rd + (n - 1) * entries] < t:
+        return None
+
+    # Discard recorded samples outside of interpolation window
+    while n > 1 and ts[rd + entries] <= t - width:
+        rd += entries
+        n  -= 1
+    FIFO_RD[sid] = rd
+
+    if width == 0:
+        # Linear interpolation between recorded samples around t
+        if n == 1 or ts[rd] >= t:
+            return x[rd + axis]
+        t0 = ts[rd]
+        t1 = ts[rd + entries]
+        x0 = x[rd + axis]
+        x1 = x[rd + entries + axis]
+        return x0 + (x1 - x0) * (t - t0) / (t1 - t0)
+
+    # Windowed-sinc interpolation (Hann window)
+    acc  = 0.0
+    wsum = 0.0
+    for i in range(rd, rd + n * entries, entries):
+        u = (t - ts[i]) / T * c
+        if abs(u) >= SINC_TAPS:
+            continue
+        if u == 0:
+            w = 1.0
+        else:
+            w = math.sin(math.pi * u) / (math.pi * u)
+        w   *= 0.5 + 0.5 * math.cos(math.pi * u / SINC_TAPS)
+        acc  += w * x[i + axis]
+        wsum += w
+
+    if wsum == 0:
+        return x[rd + axis]
+
+    return acc / wsum
+
+## Pop sample value from sensor FIFO and convert it to 32-bit register value
+#  @param sid sensor id
+#  @return value scaled sample value (32-bit)
+def popFIFO(sid):
+    global FIFO_RD, RS_T, RS_E
+
+    if IsResampling(sid):
+        val = Resample(sid, RS_T[sid], RS_E[sid])
+
+        if val is None:
+            # No more samples in sensor FIFO, disable sensor
+            ENABLE[sid] = 0
+            return 0
+
+        entries = Entries(sid)
+
+        # Advance to next entry (and sample)
+        RS_E[sid] += 1
+        if RS_E[sid] == entries:
+            RS_E[sid]  = 0
+            RS_T[sid] += ODR[sid]
+
+        return int(val * SCALE[sid]) & 0xffffffff
+
+    if FillFIFO(sid, 1) > 0:
+        # Advance read cursor (Timestamp + Sample value)
+        value = ScaleFIFO(sid)
+        FIFO_RD[sid] += 1
+
+        if FillFIFO(sid, 1) == 0:
+            # No more samples in sensor FIFO, disable sensor
+            ENABLE[sid] = 0
+    else:
+        value = 0
+
     return value
 
 ## Read FIFO register (user register)
+#  @param sid sensor id
 #  @return value value read (32-bit)
-def rdFIFO():
-    global SELECT, FIFO, FIFO_TS, FIFO_CNT
+def rdFIFO(sid):
+    global FIFO_CNT
 
-    sid = SELECT
+    UpdateFIFO(sid)
 
-    if len(FIFO[sid]) > 0 and FIFO_CNT[sid] > 0:
-        # Pop sample from FIFOs (Timestamp + Sample value)
-        FIFO_TS[sid].pop(0)
-        val = FIFO[sid].pop(0)
+    if FIFO_CNT[sid] > 0 and FillFIFO(sid, 1) > 0:
+        value = popFIFO(sid)
         # Decrement virtual FIFO counter
         FIFO_CNT[sid] -= 1
+    else:
+        value = 0
 
-        if len(FIFO[sid]) == 0:
-            # No more samples in sensor FIFO, disable sensor
-            ENABLE[sid] = 0
+    SLOG[sid].debug("Read FIFO[%d]: %d", sid, value)
+    return value
+
+## Read FIFO_TS register (user register)
+#  @param sid sensor id
+#  @return value value read (32-bit, timestamp modulo 2^32)
+def rdFIFO_TS(sid):
+    global FIFO_CNT
+
+    UpdateFIFO(sid)
+
+    if FIFO_CNT[sid] > 0 and IsResampling(sid):
+        value = RS_T[sid] & 0xffffffff
+    elif FIFO_CNT[sid] > 0 and FillFIFO(sid, 1) > 0:
+        value = FIFO_TS[sid][FIFO_RD[sid]] & 0xffffffff
     else:
-        val = 0
+        value = 0
 
-    scaled_float = float(val) * SCALE[sid]
+    SLOG[sid].debug("Read FIFO_TS[%d]: %d", sid, value)
+    return value
 
-    value = int(scaled_float)
-    value &= 0xffffffff
+## Read WATERMARK register (user register)
+#  @param sid sensor id
+#  @return value value read (32-bit)
+def rdWATERMARK(sid):
+    global WATERMARK
 
-    logging.debug("Read FIFO[{}]: {} ({})".format(sid, value, val))
+    value = WATERMARK[sid]
+
+    SLOG[sid].debug("Read WATERMARK[%d]: %d", sid, value)
     return value
 
+## Write WATERMARK register (user register)
+#  @param sid sensor id
+#  @param value value to write (32-bit)
+def wrWATERMARK(sid, value):
+    global WATERMARK
+
+    SLOG[sid].debug("Write WATERMARK[%d] = %d", sid, value)
+
+    WATERMARK[sid] = value
+
+## Read OVERRUN register (user register)
+#  @param sid sensor id
+#  @return value value read (32-bit)
+def rdOVERRUN(sid):
+    global OVERRUN
+
+    UpdateFIFO(sid)
+
+    value = OVERRUN[sid] & 0xffffffff
+
+    SLOG[sid].debug("Read OVERRUN[%d]: %d", sid, value)
+    return value
+
+## Read LATENCY register (user register)
+#  @return value value read (32-bit)
+def rdLATENCY():
+    global LATENCY
+
+    value = LATENCY
+
+    log.debug("Read LATENCY: %d", value)
+    return value
+
+## Write LATENCY register (user register)
+#  @param value value to write (32-bit)
+def wrLATENCY(value):
+    global LATENCY
+
+    log.debug("Write LATENCY = %d", value)
+
+    LATENCY = value
+
+## Read STREAM register (user register)
+#  @return value value read (32-bit)
+def rdSTREAM():
+    global STREAM_SID
+
+    if STREAM_SID >= 0:
+        value = BIT_STREAM_ENABLE | STREAM_SID
+    else:
+        value = 0
+
+    log.debug("Read STREAM: %d", value)
+    return value
+
+## Write STREAM register (user register)
+#  @param value value to write (32-bit)
+def wrSTREAM(value):
+    global STREAM_SID, FIFO_CNT
+    log.debug("Write STREAM = %d", value)
+
+    sid = value & MSK_STREAM_SID
+
+    if (value & BIT_STREAM_ENABLE) and sid < SENSOR_COUNT:
+        STREAM_SID = sid
+        # Streamed samples are not counted in FIFO
+        FIFO_CNT[sid] = 0
+    else:
+        if STREAM_SID >= 0:
+            # Samples are counted in FIFO again from now on
+            RestartODR(STREAM_SID)
+        STREAM_SID = -1
+
+# SCENARIO
+# ========
+
+# Scenario file mode names
+SCENARIO_PLAYBACK  = { "odr": PLAYBACK_ODR, "timestamp": PLAYBACK_TIMESTAMP }
+SCENARIO_RESAMPLE  = { "none": RESAMPLE_NONE, "linear": RESAMPLE_LINEAR, "sinc": RESAMPLE_SINC }
+SCENARIO_OVERRUN   = { "drop_oldest": OVERRUN_DROP_OLDEST, "drop_newest": OVERRUN_DROP_NEWEST }
+SCENARIO_LEVEL     = ( "DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL" )
+SCENARIO_GENERATOR = ( "sine", "chirp", "white", "pink", "step", "loop" )
+
+# Scenario file setting names (global, per sensor and generator settings)
+SCENARIO_KEYS = ( "verbosity", "trace_records", "trace_file", "cache", "parse_workers",
+                  "start", "end", "file", "playback", "resample", "sensors" )
+SCENARIO_SENSOR_KEYS = ( "file", "columns", "generator", "odr", "scale", "fifo_depth",
+                         "overrun", "playback", "resample", "trace" )
+SCENARIO_GENERATOR_KEYS = ( "type", "odr", "samples", "amplitude", "offset", "frequency",
+                            "f0", "f1", "duration", "period", "seed" )
+
+## Reject scenario with invalid setting
+#  @param key setting name
+#  @param value setting value from scenario file
+#  @param expected description of valid values
+def scenarioError(key, value, expected):
+    raise ValueError("Invalid scenario setting {}: {!r}, {} expected".format(key, value, expected))
+
+## Check that scenario settings object contains known settings only
+#  @param key name of settings object ("" = scenario file)
+#  @param cfg settings object from scenario file
+#  @param keys known setting names
+#  @return cfg settings object
+def scenarioObject(key, cfg, keys):
+    if not isinstance(cfg, dict):
+        scenarioError(key or "file content", cfg, "object")
+
+    for k in cfg:
+        if k not in keys:
+            raise ValueError("Unknown scenario setting {}{}".format(key + "." if key else "", k))
+
+    return cfg
+
+## Get scenario setting value from its mode name
+#  @param key setting name
+#  @param name mode name from scenario file
+#  @param modes mode names (name: value)
+#  @return value setting value
+def scenarioMode(key, name, modes):
+    if not isinstance(name, str) or name not in modes:
+        scenarioError(key, name, " | ".join(modes))
+
+    return modes[name]
+
+## Get log level from scenario setting
+#  @param key setting name
+#  @param name level name from scenario file
+#  @return level level name
+def scenarioLevel(key, name):
+    if not isinstance(name, str) or name.upper() not in SCENARIO_LEVEL:
+        scenarioError(key, name, " | ".join(SCENARIO_LEVEL))
+
+    return name.upper()
+
+## Check numeric scenario setting
+# Invalid value would otherwise fail later in timer or DMA callbacks of the
+# simulation.
+#  @param key setting name
+#  @param value setting value from scenario file
+#  @param minimum smallest valid value (None = any)
+#  @param integer integer required (otherwise integer or float)
+#  @return value setting value
+def scenarioNumber(key, value, minimum=0, integer=True):
+    kind = int if integer else (int, float)
+
+    if isinstance(value, bool) or not isinstance(value, kind) or \
+       (minimum is not None and value < minimum):
+        scenarioError(key, value, "{}{}".format("integer" if integer else "number",
+                                                "" if minimum is None else " >= {}".format(minimum)))
+
+    return value
+
+## Check on/off scenario setting
+#  @param key setting name
+#  @param value setting value from scenario file
+#  @return value 1 (on) or 0 (off)
+def scenarioFlag(key, value):
+    if value not in (True, False, 0, 1):
+        scenarioError(key, value, "true | false")
+
+    return int(value)
+
+## Check file name scenario setting
+#  @param key setting name
+#  @param value setting value from scenario file
+#  @param path directory of scenario file
+#  @return value file name
+def scenarioFile(key, value, path):
+    if not isinstance(value, str) or value == "":
+        scenarioError(key, value, "file name")
+
+    return os.path.join(path, value)
+
+## Check generator scenario settings (see Generator)
+#  @param key setting name
+#  @param cfg generator settings from scenario file
+#  @return cfg generator settings
+def scenarioGenerator(key, cfg):
+    scenarioObject(key, cfg, SCENARIO_GENERATOR_KEYS)
+
+    if "type" in cfg:
+        scenarioMode(key + ".type", cfg["type"], dict.fromkeys(SCENARIO_GENERATOR))
+
+    for k, minimum, integer in (("odr", 1, True), ("samples", 0, True), ("period", 1, True),
+                                ("seed", None, True), ("amplitude", None, False),
+                                ("offset", None, False), ("frequency", 0, False),
+                                ("f0", 0, False), ("f1", 0, False), ("duration", 0, False)):
+        if k in cfg:
+            scenarioNumber(key + "." + k, cfg[k], minimum, integer)
+
+    if cfg.get("duration", 1) == 0:
+        scenarioError(key + ".duration", cfg["duration"], "number > 0")
+
+    return cfg
+
+## Load scenario file
+# Scenario file (JSON) selects model settings without editing this script:
+#   {
+#     "verbosity": "ERROR",                   log level (DEBUG, INFO, ...)
+#     "trace_records": 65536,                 register trace (0 = off)
+#     "trace_file": "vsi0_trace.bin",         register trace file
+#     "cache":     true,                      parsed data cache (CSV files)
+#     "parse_workers": 1,                     parsing processes (default 1,
+#                                             0 = CPUs, parallel is opt-in)
+#     "start":     1800000000,                playback window start and end
+#     "end":       1830000000,                (recorded time, microseconds)
+#     "file":      "sensor_samples0.csv",     default data file
+#     "playback":  "odr" | "timestamp",       default playback mode
+#     "resample":  "none" | "linear" | "sinc" default resampling mode
+#     "sensors": {                            per sensor settings (by name)
+#       "acc": {
+#         "file":       "imu.bin",            own data file (see sources)
+#         "columns":    [ "ax", "ay", "az" ], CSV column names
+#         "generator":  { "type": "sine" },   synthetic source (see Generator)
+#         "odr":        1000,                 output data rate (microseconds)
+#         "scale":      100000,               scale register value
+#         "fifo_depth": 1024,                 FIFO depth (samples, 0 = none)
+#         "overrun":    "drop_oldest" | "drop_newest",
+#         "playback":   "odr" | "timestamp",
+#         "resample":   "none" | "linear" | "sinc",
+#         "trace":      "DEBUG"               log level of sensor registers
+#       }
+#     }
+#   }
+# Relative file names are relative to the scenario file. Numeric settings
+# must be non-negative integers (scale positive).
+# Scenario with invalid content (JSON syntax, unknown setting, invalid value)
+# is rejected as a whole: ValueError naming the setting is raised before any
+# setting is applied. Without scenario file default settings are used.
+#  @param file_name scenario file name
+#  @return settings per sensor settings (sensor id: settings)
+def loadScenario(file_name):
+    global FILE_NAME_SENSOR, FILE_NAME_TRACE, playback, resample, sources, generator, trace, cache, parse_workers, window_start, window_end
+
+    try:
+        with open(file_name) as f:
+            scenario = json.load(f)
+    except OSError:
+        log.info("No scenario file {}, using default settings".format(file_name))
+        return {}
+    except ValueError as e:
+        raise ValueError("Invalid scenario file {}: {}".format(file_name, e))
+
+    path = os.path.dirname(file_name)
+
+    # Check all settings first, scenario is applied only when it is valid
+    g = dict()
+
+    scenarioObject("", scenario, SCENARIO_KEYS)
+
+    if "verbosity" in scenario:
+        g["verbosity"] = scenarioLevel("verbosity", scenario["verbosity"])
+    if "file" in scenario:
+        g["file"] = scenarioFile("file", scenario["file"], path)
+    if "trace_records" in scenario:
+        g["trace_records"] = scenarioNumber("trace_records", scenario["trace_records"])
+    if "trace_file" in scenario:
+        g["trace_file"] = scenarioFile("trace_file", scenario["trace_file"], path)
+    if "cache" in scenario:
+        g["cache"] = scenarioFlag("cache", scenario["cache"])
+    if "parse_workers" in scenario:
+        g["parse_workers"] = scenarioNumber("parse_workers", scenario["parse_workers"])
+    if "start" in scenario:
+        g["start"] = scenarioNumber("start", scenario["start"])
+    if "end" in scenario:
+        g["end"] = scenarioNumber("end", scenario["end"])
+    if "playback" in scenario:
+        g["playback"] = scenarioMode("playback", scenario["playback"], SCENARIO_PLAYBACK)
+    if "resample" in scenario:
+        g["resample"] = scenarioMode("resample", scenario["resample"], SCENARIO_RESAMPLE)
+
+    settings = {}
+    files    = {}
+    gens     = {}
+
+    for name, cfg in scenarioObject("sensors", scenario.get("sensors", {}), SENSOR_NAME).items():
+        key = "sensors." + name
+        sid = SENSOR_NAME.index(name)
+        s   = {}
+
+        scenarioObject(key, cfg, SCENARIO_SENSOR_KEYS)
+
+        for k, minimum in (("odr", 0), ("scale", 1), ("fifo_depth", 0)):
+            if k in cfg:
+                s[k] = scenarioNumber(key + "." + k, cfg[k], minimum)
+        if "overrun" in cfg:
+            s["overrun"] = scenarioMode(key + ".overrun", cfg["overrun"], SCENARIO_OVERRUN)
+        if "playback" in cfg:
+            s["playback"] = scenarioMode(key + ".playback", cfg["playback"], SCENARIO_PLAYBACK)
+        if "resample" in cfg:
+            s["resample"] = scenarioMode(key + ".resample", cfg["resample"], SCENARIO_RESAMPLE)
+        if "trace" in cfg:
+            s["trace"] = scenarioLevel(key + ".trace", cfg["trace"])
+
+        if "file" in cfg:
+            files[sid] = { 'file': scenarioFile(key + ".file", cfg["file"], path) }
+            if "columns" in cfg:
+                columns = cfg["columns"]
+                if not isinstance(columns, list) or len(columns) != Entries(sid) or \
+                   not all(isinstance(c, str) for c in columns):
+                    scenarioError(key + ".columns", columns, "{} column names".format(Entries(sid)))
+                files[sid]['columns'] = columns
+        elif "columns" in cfg:
+            raise ValueError("Scenario setting {}.columns requires {}.file".format(key, key))
+        if "generator" in cfg:
+            gens[sid] = scenarioGenerator(key + ".generator", cfg["generator"])
+
+        settings[sid] = s
+
+    # Apply valid scenario
+    if "verbosity" in g:
+        log.setLevel(g["verbosity"])
+    FILE_NAME_SENSOR = g.get("file", FILE_NAME_SENSOR)
+    trace            = g.get("trace_records", trace)
+    FILE_NAME_TRACE  = g.get("trace_file", FILE_NAME_TRACE)
+    cache            = g.get("cache", cache)
+    parse_workers    = g.get("parse_workers", parse_workers)
+    window_start     = g.get("start", window_start)
+    window_end       = g.get("end", window_end)
+    playback         = g.get("playback", playback)
+    resample         = g.get("resample", resample)
+    sources.update(files)
+    generator.update(gens)
+
+    log.info("Scenario file {} loaded".format(file_name))
+
+    return settings
+
+## Apply per sensor scenario settings (after data files are opened)
+#  @param settings per sensor settings (sensor id: checked settings)
+def configureSensors(settings):
+    global ODR, SCALE, FIFO_DEPTH, OVERRUN_POLICY, PLAYBACK, RESAMPLE
+
+    for sid, cfg in settings.items():
+        if "odr" in cfg:
+            ODR[sid] = cfg["odr"]
+        if "scale" in cfg:
+            SCALE[sid] = cfg["scale"]
+        if "fifo_depth" in cfg:
+            FIFO_DEPTH[sid] = cfg["fifo_depth"]
+        if "overrun" in cfg:
+            OVERRUN_POLICY[sid] = cfg["overrun"]
+        if "playback" in cfg:
+            PLAYBACK[sid] = cfg["playback"]
+        if "resample" in cfg:
+            RESAMPLE[sid] = cfg["resample"]
+        if "trace" in cfg:
+            SLOG[sid].setLevel(cfg["trace"])
+
 # VSI IMPLEMENTATION
 # ==================
 
 ## Initialize
 def init():
     global INTERVAL
-    logging.info("init() called")
-    logging.debug("Current working directory: {}".format(os.getcwd()))
+    log.info("init() called")
+    log.debug("Current working directory: {}".format(os.getcwd()))
+
+    settings = loadScenario(FILE_NAME_SCENARIO)
 
     CreateUserRegisters()
    
-    openDataFile(FILE_NAME_SENSOR)
+    # Sensors without own data file share the default data file
+    shared = [sid for sid in range(SENSOR_COUNT) if sid not in sources]
+    if len(shared) > 0:
+        openDataFile(FILE_NAME_SENSOR, shared)
+
+    openSources()
+    openGenerators()
+
+    configureSensors(settings)
+
+    startTrace()
 
     # Initialize timer interval register
     INTERVAL = CalculateInterval()
@@ -529,10 +2557,10 @@ def init():
 #  @return value value read (32-bit)
 def rdIRQ():
     global IRQ_Status
-    logging.info("rdIRQ() called")
+    log.info("rdIRQ() called")
 
     value = IRQ_Status
-    logging.debug("Read interrupt request: {}".format(value))
+    log.debug("Read interrupt request: %d", value)
 
     return value
 
@@ -542,10 +2570,10 @@ def rdIRQ():
 #  @return value value written (32-bit)
 def wrIRQ(value):
     global IRQ_Status
-    logging.info("wrIRQ(value={}) called".format(value))
+    log.info("wrIRQ(value=%d) called", value)
 
     IRQ_Status = value
-    logging.debug("Write interrupt request: {}".format(value))
+    log.debug("Write interrupt request: %d", value)
 
     return value
 
@@ -556,26 +2584,29 @@ def wrIRQ(value):
 #  @return value value written (32-bit)
 def wrTimer(index, value):
     global Timer_Control, Timer_Interval
-    logging.info("wrTimer(index={}, value={}) called".format(index, value))
+    log.info("wrTimer(index=%d, value=%d) called", index, value)
 
     if   index == 0:
         Timer_Control = value
-        logging.debug("Write Timer_Control: {}".format(value))
+        log.debug("Write Timer_Control: %d", value)
     elif index == 1:
         Timer_Interval = value
-        logging.debug("Write Timer_Interval: {}".format(value))
+        log.debug("Write Timer_Interval: %d", value)
 
     return value
 
 
 ## Timer event (called at Timer Overflow)
+# Timer is armed one-shot at the next FIFO watermark/latency deadline
+# (see CalculateInterval), so every timer event requests an interrupt and
+# the driver re-arms the timer in its interrupt handler. While streaming,
+# the periodic timer requests an interrupt for each DMA block.
 def timerEvent():
-    global Timer_Event
-    logging.info("timerEvent() called")
+    global Timer_Event, Timer_Time
+    log.info("timerEvent() called")
 
     Timer_Event += 1
-
-    IntervalHandler()
+    Timer_Time  += Timer_Interval
 
 
 ## Write DMA registers (the VSI DMA Registers)
@@ -583,57 +2614,95 @@ def timerEvent():
 #  @param value value to write (32-bit)
 #  @return value value written (32-bit)
 def wrDMA(index, value):
-    global DMA_Control
-    logging.info("wrDMA(index={}, value={}) called".format(index, value))
+    global DMA_Control, DMA_Address, DMA_BlockSize, DMA_BlockNum
+    log.info("wrDMA(index=%d, value=%d) called", index, value)
 
     if   index == 0:
         DMA_Control = value
-        logging.debug("Write DMA_Control: {}".format(value))
+        log.debug("Write DMA_Control: %d", value)
+    elif index == 1:
+        DMA_Address = value
+        log.debug("Write DMA_Address: %d", value)
+    elif index == 2:
+        DMA_BlockSize = value
+        log.debug("Write DMA_BlockSize: %d", value)
+    elif index == 3:
+        DMA_BlockNum = value
+        log.debug("Write DMA_BlockNum: %d", value)
 
     return value
 
 
 ## Read data from peripheral for DMA P2M transfer (VSI DMA)
+#  Block is filled with samples of the streamed sensor (32-bit little-endian
+#  FIFO entries). Block is padded with zeros when recording is exhausted.
 #  @param size size of data to read (in bytes, multiple of 4)
 #  @return data data read (bytearray)
 def rdDataDMA(size):
-    logging.info("rdDataDMA(size={}) called".format(size))
+    log.info("rdDataDMA(size=%d) called", size)
+
+    data = bytearray(size)
+    sid  = STREAM_SID
 
-    return bytearray()
+    if sid >= 0 and ENABLE[sid] and (DMA_Control & DMA_Control_Enable_Msk):
+        for i in range(0, size, 4):
+            if FillFIFO(sid, 1) == 0:
+                break
+            data[i:i+4] = popFIFO(sid).to_bytes(4, 'little')
+
+    return data
 
 
 ## Write data to peripheral for DMA M2P transfer (VSI DMA)
 #  @param data data to write (bytearray)
 #  @param size size of data to write (in bytes, multiple of 4)
 def wrDataDMA(data, size):
-    logging.info("wrDataDMA(data={}, size={}) called".format(data, size))
+    log.info("wrDataDMA(data=%s, size=%d) called", data, size)
 
 
 ## Read user registers (the VSI User Registers)
 #  @param index user register index (zero based)
 #  @return value value read (32-bit)
 def rdRegs(index):
-    logging.info("rdRegs(index={}) called".format(index))
-
-    if   index == IDX_ENABLE:
-        value = rdENABLE()
+    if index >= IDX_BANK_BASE:
+        # Sensor register bank
+        sid    = (index - IDX_BANK_BASE) // IDX_BANK_SIZE
+        offset = (index - IDX_BANK_BASE) %  IDX_BANK_SIZE
+
+        if sid >= SENSOR_COUNT:
+            value = 0
+        elif offset == OFS_ENABLE:
+            value = rdENABLE(sid)
+        elif offset == OFS_SCALE:
+            value = rdSCALE(sid)
+        elif offset == OFS_ODR:
+            value = rdODR(sid)
+        elif offset == OFS_FIFO_CNT:
+            value = rdFIFO_CNT(sid)
+        elif offset == OFS_FIFO:
+            value = rdFIFO(sid)
+        elif offset == OFS_FIFO_TS:
+            value = rdFIFO_TS(sid)
+        elif offset == OFS_WATERMARK:
+            value = rdWATERMARK(sid)
+        elif offset == OFS_OVERRUN:
+            value = rdOVERRUN(sid)
+        else:
+            value = 0
     elif index == IDX_STATUS:
         value = rdSTATUS()
     elif index == IDX_INTERVAL:
         value = rdINTERVAL()
-    elif index == IDX_SELECT:
-        value = rdSELECT()
-    elif index == IDX_SCALE:
-        value = rdSCALE()
-    elif index == IDX_ODR:
-        value = rdODR()
-    elif index == IDX_FIFO_CNT:
-        value = rdFIFO_CNT()
-    elif index == IDX_FIFO:
-        value = rdFIFO()
+    elif index == IDX_STREAM:
+        value = rdSTREAM()
+    elif index == IDX_LATENCY:
+        value = rdLATENCY()
     else:
         value = 0
 
+    if TRACE_BUF is not None:
+        Trace(TRACE_RD, index, value)
+
     return value
 
 
@@ -642,31 +2711,43 @@ def rdRegs(index):
 #  @param value value to write (32-bit)
 #  @return value value written (32-bit)
 def wrRegs(index, value):
-    logging.info("wrRegs(index={}, value={}) called".format(index, value))
-
-    if   index == IDX_ENABLE:
-        wrENABLE(value)
-    elif index == IDX_SELECT:
-        wrSELECT(value)
-    elif index == IDX_SCALE:
-        wrSCALE(value)
-    elif index == IDX_ODR:
-        wrODR(value)
+    if index >= IDX_BANK_BASE:
+        # Sensor register bank
+        sid    = (index - IDX_BANK_BASE) // IDX_BANK_SIZE
+        offset = (index - IDX_BANK_BASE) %  IDX_BANK_SIZE
+
+        if sid >= SENSOR_COUNT:
+            pass
+        elif offset == OFS_ENABLE:
+            wrENABLE(sid, value)
+        elif offset == OFS_SCALE:
+            wrSCALE(sid, value)
+        elif offset == OFS_ODR:
+            wrODR(sid, value)
+        elif offset == OFS_WATERMARK:
+            wrWATERMARK(sid, value)
+    elif index == IDX_STREAM:
+        wrSTREAM(value)
+    elif index == IDX_LATENCY:
+        wrLATENCY(value)
+
+    if TRACE_BUF is not None:
+        Trace(TRACE_WR, index, value)
 
     return value
 
 ## @}
 
 def main():
-    global SELECT, FIFO_CNT
+    global FIFO_CNT
     init()
     enTEMP(1)
     enACC(1)
 
-    SELECT = 3
-    FIFO_CNT[SELECT] = 7 * 3
-    
-    while FIFO_CNT[SELECT]:
-        rdFIFO()
+    sid = SID_ACC
+    FIFO_CNT[sid] = 7 * 3
+
+    while FIFO_CNT[sid]:
+        rdFIFO(sid)
 
 if __name__ == '__main__': main()
@@ -0,0 +1,29 @@
+# Copyright (c) 2022 Arm Limited. All rights reserved.
+
+# Virtual Streaming Interface instance 4 Python script: Sensor Interface
+#
+# Loads a separate copy of the sensor model (arm_vsi0.py) for VSI instance 4.
+# Sensor data is read from sensor_samples4.csv.
+
+import importlib.util
+import os
+import sys
+
+_name = os.path.splitext(os.path.basename(__file__))[0]
+_spec = importlib.util.spec_from_file_location(_name + "_sensor", os.path.join(os.path.dirname(os.path.abspath(__file__)), "arm_vsi0.py"))
+_model = importlib.util.module_from_spec(_spec)
+sys.modules[_spec.name] = _model
+_spec.loader.exec_module(_model)
+
+# VSI IMPLEMENTATION
+# ==================
+init       = _model.init
+rdIRQ      = _model.rdIRQ
+wrIRQ      = _model.wrIRQ
+wrTimer    = _model.wrTimer
+timerEvent = _model.timerEvent
+wrDMA      = _model.wrDMA
+rdDataDMA  = _model.rdDataDMA
+wrDataDMA  = _model.wrDataDMA
+rdRegs     = _model.rdRegs
+wrRegs     = _model.wrRegs
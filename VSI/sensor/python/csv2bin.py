@@ -0,0 +1,69 @@
+# Copyright (c) 2022 Arm Limited. All rights reserved.
+
+# Sensor data converter: CSV recording to binary recording format
+#
+# Binary recording is memory mapped by the sensor model (arm_vsi0.py) and
+# needs no parsing at simulation startup. The model detects the format from
+# the file header, so the binary file can simply replace the CSV file:
+#
+#   python csv2bin.py sensor_samples0.csv sensor_samples0.bin
+#   (rename sensor_samples0.bin to sensor_samples0.csv or point
+#    FILE_NAME_SENSOR to it)
+
+import logging
+import sys
+
+import arm_vsi0 as model
+
+## Convert CSV recording to binary recording
+#  @param csv_name input CSV file name
+#  @param bin_name output binary file name
+#  @param scale scale stored for all sensors (0 = model default)
+def csv2bin(csv_name, bin_name, scale=0):
+
+    model.CreateUserRegisters()
+    model.openDataFile(csv_name)
+
+    # CSV readers of sensors present in recording (before ODR detection
+    # switches readers to a valid parsed data cache)
+    readers = [(sid, model.READER[sid]) for sid in range(model.SENSOR_COUNT) if model.READER[sid] is not None]
+
+    for sid, r in readers:
+        # Recorded ODR from the first samples
+        model.DetectODR(sid)
+
+    # Parse all sensors in a single pass (in parallel for large files)
+    columns = list()
+    if len(readers) > 0:
+        columns = model.parseColumns(csv_name, [r.cols for sid, r in readers], readers[0][1].ts_col)
+
+    sensors = list()
+
+    for (sid, r), (ts, val) in zip(readers, columns):
+        model.FIFO_TS[sid], model.FIFO[sid] = ts, val
+
+        if len(model.FIFO[sid]) == 0:
+            continue
+
+        sensors.append((sid, model.Entries(sid)))
+
+    with open(bin_name, "wb") as f:
+        model.writeBinFile(f, [(sid, entries, scale or model.SCALE[sid], model.ODR[sid],
+                                model.FIFO_TS[sid], model.FIFO[sid]) for sid, entries in sensors])
+
+    for sid, entries in sensors:
+        print("{}: {} samples, ODR={} us".format(model.CSV_Sensor_Cols[sid][0].rstrip("X"), len(model.FIFO[sid]) // entries, model.ODR[sid]))
+
+def main():
+    if len(sys.argv) < 3:
+        print("Usage: python csv2bin.py <input.csv> <output.bin> [scale]")
+        sys.exit(1)
+
+    logging.getLogger(model.log.name).setLevel(logging.WARNING)
+
+    # Standalone interpreter, parse large files using all CPUs
+    model.parse_workers = 0
+
+    csv2bin(sys.argv[1], sys.argv[2], int(sys.argv[3]) if len(sys.argv) > 3 else 0)
+
+if __name__ == '__main__': main()
@@ -0,0 +1,70 @@
+# Copyright (c) 2022 Arm Limited. All rights reserved.
+
+# Sensor model register trace decoder
+#
+# Register trace is written by the sensor model (arm_vsi0.py) at exit when
+# enabled (trace setting or "trace_records" in scenario file):
+#
+#   python trace_decode.py vsi0_trace.bin
+
+import sys
+
+import arm_vsi0 as model
+
+# Global register names
+REG_NAME = {
+    model.IDX_STATUS:   "STATUS",
+    model.IDX_INTERVAL: "INTERVAL",
+    model.IDX_STREAM:   "STREAM",
+    model.IDX_LATENCY:  "LATENCY",
+}
+
+# Sensor register bank names
+BANK_NAME = {
+    model.OFS_ENABLE:    "ENABLE",
+    model.OFS_SCALE:     "SCALE",
+    model.OFS_ODR:       "ODR",
+    model.OFS_FIFO_CNT:  "FIFO_CNT",
+    model.OFS_FIFO:      "FIFO",
+    model.OFS_FIFO_TS:   "FIFO_TS",
+    model.OFS_WATERMARK: "WATERMARK",
+    model.OFS_OVERRUN:   "OVERRUN",
+}
+
+## Get register name
+#  @param index user register index
+#  @return register name
+def regName(index):
+    if index >= model.IDX_BANK_BASE:
+        sid, offset = divmod(index - model.IDX_BANK_BASE, model.IDX_BANK_SIZE)
+        if sid < model.SENSOR_COUNT:
+            return "{}.{}".format(model.SENSOR_NAME[sid].upper(), BANK_NAME.get(offset, offset))
+    return REG_NAME.get(index, "REG{}".format(index))
+
+## Decode register trace file
+#  @param file_name trace file name
+def decode(file_name):
+    with open(file_name, "rb") as f:
+        data = f.read()
+
+    magic, version, instance, num = model.TRACE_HEADER.unpack_from(data, 0)
+    if magic != model.TRACE_MAGIC or version != model.TRACE_VERSION:
+        print("{}: not a register trace file".format(file_name))
+        sys.exit(1)
+
+    print("VSI{}: {} records".format(instance, num))
+
+    start = model.TRACE_HEADER.size
+    end   = start + num * model.TRACE_RECORD.size
+    for time, index, direction, value in model.TRACE_RECORD.iter_unpack(data[start:end]):
+        print("{:>12} us  {}  {:<16} {:>10}  (0x{:08X})".format(time,
+              "R" if direction == model.TRACE_RD else "W", regName(index), value, value))
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: python trace_decode.py <trace.bin>")
+        sys.exit(1)
+
+    decode(sys.argv[1])
+
+if __name__ == '__main__': main()
@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2022 Arm Limited. All rights reserved.
+ */
+
+/* Host test stub: run time environment components */
+
+#ifndef RTE_COMPONENTS_H
+#define RTE_COMPONENTS_H
+
+#define CMSIS_device_header "test_device.h"
+
+#endif /* RTE_COMPONENTS_H */
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2022 Arm Limited. All rights reserved.
+ */
+
+/* Host test stub: device header with simulated VSI peripheral and NVIC */
+
+#ifndef TEST_DEVICE_H
+#define TEST_DEVICE_H
+
+#include <stdint.h>
+#include "arm_vsi.h"
+
+typedef struct {
+  volatile uint32_t ISER[16];
+  volatile uint32_t ICER[16];
+} NVIC_Type;
+
+extern NVIC_Type    Test_NVIC;
+extern ARM_VSI_Type Test_VSI0;
+
+#define NVIC        (&Test_NVIC)
+
+/* VSI peripheral registers in host memory */
+#undef  ARM_VSI0
+#define ARM_VSI0    (&Test_VSI0)
+
+#define __DSB()
+#define __ISB()
+#define __DMB()
+
+#endif /* TEST_DEVICE_H */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022 Arm Limited. All rights reserved.
+ */
+
+/*
+ * Host unit test for the scalar implementation of sensor data conversion.
+ *
+ * Build and run on the host (without Helium, scalar code path):
+ *   gcc -std=c99 -Wall -Wextra -I../include test_sensor_convert.c ../driver/sensor_convert.c -o test_sensor_convert -lm
+ *   ./test_sensor_convert
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "sensor_convert.h"
+
+#if defined(__ARM_FEATURE_MVE)
+#error "Host test is intended for the scalar code path"
+#endif
+
+/* Maximum number of entries (not a multiple of 4 to exercise the tail) */
+#define TEST_ENTRIES    (3U * 13U)
+
+/* Allowed relative deviation from per-sample division */
+#define TEST_EPSILON    1.0e-6f
+
+static uint32_t failures;
+
+/* Compare converted value with per-sample reference (float)raw / scale */
+static void Check (const char *name, uint32_t idx, float val, int32_t raw, int32_t scale) {
+  float ref = (float)raw / (float)scale;
+
+  if (fabsf(val - ref) > (fabsf(ref) * TEST_EPSILON)) {
+    printf("FAIL %s[%u]: %g != %g\n", name, idx, (double)val, (double)ref);
+    failures++;
+  }
+}
+
+/* Generate raw samples with mixed signs and magnitudes */
+static void Generate (int32_t *raw, uint32_t num) {
+  uint32_t i;
+
+  for (i = 0U; i < num; i++) {
+    raw[i] = (int32_t)((i * 7919U) % 65536U) - 32768;
+  }
+}
+
+static void TestConvertData (int32_t scale) {
+  int32_t  raw[TEST_ENTRIES];
+  float    dst[TEST_ENTRIES + 1U];
+  uint32_t num, i;
+
+  Generate(raw, TEST_ENTRIES);
+
+  /* All lengths 0 .. TEST_ENTRIES, including tails of 1..3 entries */
+  for (num = 0U; num <= TEST_ENTRIES; num++) {
+    dst[num] = -1.0f;
+    Sensor_ConvertData(raw, dst, num, scale);
+    for (i = 0U; i < num; i++) {
+      Check("data", i, dst[i], raw[i], scale);
+    }
+    /* Entry beyond the requested length must not be written */
+    if (dst[num] != -1.0f) {
+      printf("FAIL data: wrote beyond %u entries\n", num);
+      failures++;
+    }
+  }
+}
+
+static void TestConvertAxes (int32_t scale) {
+  int32_t  raw[TEST_ENTRIES];
+  float    x[TEST_ENTRIES / 3U], y[TEST_ENTRIES / 3U], z[TEST_ENTRIES / 3U];
+  uint32_t num, i;
+
+  Generate(raw, TEST_ENTRIES);
+
+  /* All sample counts 0 .. 13, including tails not a multiple of 4 */
+  for (num = 0U; num <= (TEST_ENTRIES / 3U); num++) {
+    Sensor_ConvertAxes(raw, x, y, z, num, scale);
+    for (i = 0U; i < num; i++) {
+      Check("x", i, x[i], raw[(3U * i) + 0U], scale);
+      Check("y", i, y[i], raw[(3U * i) + 1U], scale);
+      Check("z", i, z[i], raw[(3U * i) + 2U], scale);
+    }
+  }
+}
+
+static void TestInvalid (void) {
+  int32_t  raw[6] = { 1, 2, 3, 4, 5, 6 };
+  float    dst[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+  float    x[3]   = { -1.0f, -1.0f, -1.0f };
+  float    y[3]   = { -1.0f, -1.0f, -1.0f };
+  float    z[3]   = { -1.0f, -1.0f, -1.0f };
+  uint32_t i;
+
+  /* Zero scale writes zero data of the requested length only */
+  Sensor_ConvertData(raw, dst, 3U, 0);
+  for (i = 0U; i < 3U; i++) {
+    if (dst[i] != 0.0f) {
+      printf("FAIL invalid data[%u]: %g != 0\n", i, (double)dst[i]);
+      failures++;
+    }
+  }
+  if (dst[3] != -1.0f) {
+    printf("FAIL invalid data: wrote beyond 3 entries\n");
+    failures++;
+  }
+
+  Sensor_ConvertAxes(raw, x, y, z, 2U, 0);
+  for (i = 0U; i < 2U; i++) {
+    if ((x[i] != 0.0f) || (y[i] != 0.0f) || (z[i] != 0.0f)) {
+      printf("FAIL invalid axes[%u]: not 0\n", i);
+      failures++;
+    }
+  }
+  if ((x[2] != -1.0f) || (y[2] != -1.0f) || (z[2] != -1.0f)) {
+    printf("FAIL invalid axes: wrote beyond 2 samples\n");
+    failures++;
+  }
+}
+
+int main (void) {
+  static const int32_t scales[] = { 1, 3, 100, 1000, 16384, -256 };
+  uint32_t i;
+
+  for (i = 0U; i < (sizeof(scales) / sizeof(scales[0])); i++) {
+    TestConvertData(scales[i]);
+    TestConvertAxes(scales[i]);
+  }
+  TestInvalid();
+
+  if (failures != 0U) {
+    printf("%u failures\n", failures);
+    return (1);
+  }
+
+  printf("PASS\n");
+  return (0);
+}
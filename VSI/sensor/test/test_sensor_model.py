@@ -0,0 +1,109 @@
+# Copyright (c) 2022 Arm Limited. All rights reserved.
+
+# Host test of the sensor model interrupt deadlines.
+#
+# Driver is simulated the way VSI_Handler services the model: on each timer
+# event the timer is re-armed with INTERVAL before the application drains
+# the FIFO. Run on the host:
+#   python test_sensor_model.py
+
+import importlib
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "python"))
+
+import arm_vsi0 as model
+
+REG_INTERVAL = model.IDX_INTERVAL
+
+failures = 0
+
+## Get index of a sensor register
+#  @param sid sensor id
+#  @param offset register offset within sensor register bank
+#  @return user register index
+def Reg(sid, offset):
+    return model.IDX_BANK_BASE + sid * model.IDX_BANK_SIZE + offset
+
+## Check condition and report failure
+#  @param cond condition
+#  @param msg failure message
+def Check(cond, msg):
+    global failures
+
+    if not cond:
+        print("FAIL " + msg)
+        failures += 1
+
+## Run interrupts of a sensor with watermark (and latency)
+#  @param sid sensor id
+#  @param odr output data rate (in microseconds)
+#  @param watermark FIFO watermark (in samples)
+#  @param latency latency limit (in microseconds, 0 = none)
+#  @param num number of interrupts
+#  @return list of (time, number of samples read) per interrupt
+def Run(sid, odr, watermark, latency, num):
+    # Fresh model state for each run
+    importlib.reload(model)
+
+    model.generator = { sid: { 'type': 'sine', 'odr': odr } }
+    model.init()
+
+    model.wrRegs(Reg(sid, model.OFS_WATERMARK), watermark)
+    model.wrRegs(model.IDX_LATENCY, latency)
+    model.wrRegs(Reg(sid, model.OFS_ENABLE), 1)
+
+    entries = model.Entries(sid)
+    irq     = list()
+
+    model.Timer_Interval = model.rdRegs(REG_INTERVAL)
+
+    for _ in range(num):
+        model.timerEvent()
+
+        # Interrupt handler re-arms the timer before FIFO is drained
+        model.Timer_Interval = model.rdRegs(REG_INTERVAL)
+
+        # Application thread drains the FIFO
+        cnt = model.rdRegs(Reg(sid, model.OFS_FIFO_CNT))
+        for _ in range(cnt):
+            model.rdRegs(Reg(sid, model.OFS_FIFO))
+        irq.append((model.Timer_Time, cnt // entries))
+
+    return irq
+
+## Interrupts are spaced by watermark / ODR and deliver a full watermark
+def TestWatermark():
+    for sid, odr, watermark in ((model.SID_ACC, 1000, 4), (model.SID_TEMP, 250, 7)):
+        irq = Run(sid, odr, watermark, 0, 16)
+
+        for i, (t, cnt) in enumerate(irq):
+            Check(t == (i + 1) * watermark * odr,
+                  "watermark: SID={} interrupt {} at {} us".format(sid, i, t))
+            Check(cnt == watermark,
+                  "watermark: SID={} interrupt {} read {} samples".format(sid, i, cnt))
+
+## Latency limit shorter than watermark period bounds interrupt spacing
+def TestLatency():
+    irq = Run(model.SID_ACC, 1000, 8, 2500, 16)
+
+    prev = 0
+    for i, (t, cnt) in enumerate(irq):
+        Check(t - prev <= 1000 + 2500,
+              "latency: interrupt {} after {} us".format(i, t - prev))
+        Check(cnt < 8,
+              "latency: interrupt {} read {} samples".format(i, cnt))
+        prev = t
+
+def main():
+    TestWatermark()
+    TestLatency()
+
+    if failures != 0:
+        print("{} failures".format(failures))
+        sys.exit(1)
+
+    print("PASS")
+
+if __name__ == '__main__': main()
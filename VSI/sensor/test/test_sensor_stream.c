@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2022 Arm Limited. All rights reserved.
+ */
+
+/*
+ * Host unit test for DMA block streaming of the sensor driver.
+ *
+ * VSI peripheral registers are simulated in host memory (see stub/), the
+ * test performs DMA block transfers the way the VSI DMA engine does: each
+ * timer overflow writes the next block, starting at block 0 whenever the
+ * stream is enabled.
+ *
+ * Build and run on the host:
+ *   gcc -std=c99 -Wall -Istub -I../include -I../driver -I../driver/Config -I../../include test_sensor_stream.c ../driver/sensor_drv.c ../driver/sensor_convert.c -o test_sensor_stream
+ *   ./test_sensor_stream
+ */
+
+#include <stdio.h>
+#include "sensor_drv.h"
+#include "sensor_vsi.h"
+#include "test_device.h"
+
+/* Block size (in 32-bit words, two motion sensor samples) and ring size */
+#define TEST_BLOCK_WORDS  6U
+#define TEST_BLOCK_NUM    4U
+
+NVIC_Type    Test_NVIC;
+ARM_VSI_Type Test_VSI0;
+
+static uint32_t Buf[TEST_BLOCK_NUM * TEST_BLOCK_WORDS];
+
+static uint32_t DmaIndex;               /* Next block written by DMA          */
+static uint32_t DmaSeq;                 /* Sequence number of next block      */
+
+static uint32_t failures;
+
+/* Timer overflow without DMA transfer (one-shot deadline timer) */
+static void TimerOverflow (uint32_t num) {
+  *(uint32_t *)&Test_VSI0.Timer.Count += num;
+}
+
+/* Timer overflow with DMA transfer of the next block */
+static void Transfer (uint32_t num) {
+  uint32_t i;
+
+  while (num-- != 0U) {
+    for (i = 0U; i < TEST_BLOCK_WORDS; i++) {
+      Buf[((DmaIndex & (TEST_BLOCK_NUM - 1U)) * TEST_BLOCK_WORDS) + i] = DmaSeq;
+    }
+    DmaIndex++;
+    DmaSeq++;
+    TimerOverflow(1U);
+  }
+}
+
+static void Start (Sensor_Handle_t h) {
+  int32_t rc;
+
+  rc = Sensor_StreamStart(h, SENSOR_TYPE_ACC, Buf, TEST_BLOCK_WORDS * 4U, TEST_BLOCK_NUM);
+  if (rc != SENSOR_OK) {
+    printf("FAIL start: %d\n", rc);
+    failures++;
+  }
+
+  /* DMA restarts at block 0 */
+  DmaIndex = 0U;
+}
+
+/* Read next block and compare it with expected sequence number */
+static void Expect (Sensor_Handle_t h, const char *name, uint32_t seq) {
+  int32_t  data[TEST_BLOCK_WORDS];
+  int32_t  rc;
+  uint32_t i;
+
+  rc = Sensor_ReadBlock(h, SENSOR_TYPE_ACC, data, TEST_BLOCK_WORDS);
+  if (rc != (int32_t)TEST_BLOCK_WORDS) {
+    printf("FAIL %s: read returned %d\n", name, rc);
+    failures++;
+    return;
+  }
+
+  for (i = 0U; i < TEST_BLOCK_WORDS; i++) {
+    if ((uint32_t)data[i] != seq) {
+      printf("FAIL %s: block %u instead of %u\n", name, (uint32_t)data[i], seq);
+      failures++;
+      return;
+    }
+  }
+}
+
+static void ExpectEmpty (Sensor_Handle_t h, const char *name) {
+  int32_t data[TEST_BLOCK_WORDS];
+  int32_t rc;
+
+  rc = Sensor_ReadBlock(h, SENSOR_TYPE_ACC, data, TEST_BLOCK_WORDS);
+  if (rc != 0) {
+    printf("FAIL %s: read returned %d instead of no block\n", name, rc);
+    failures++;
+  }
+}
+
+int main (void) {
+  Sensor_Handle_t h;
+  uint32_t        seq, i;
+
+  h = Sensor_GetHandle(0U);
+  Sensor_Initialize(h, NULL);
+
+  /* Streamed sensor sampling interval */
+  Test_VSI0.Regs[SENSOR_REG_BANK(SENSOR_TYPE_ACC) + SENSOR_REG_ODR] = 1000U;
+
+  /* Stream starts at timer count not aligned to the number of blocks */
+  TimerOverflow(3U);
+  Start(h);
+  ExpectEmpty(h, "first");
+
+  seq = DmaSeq;
+  Transfer(2U);
+  Expect(h, "first", seq);
+  Expect(h, "first", seq + 1U);
+  ExpectEmpty(h, "first");
+
+  /* Wrap around the ring buffer */
+  for (i = 0U; i < (2U * TEST_BLOCK_NUM); i++) {
+    seq = DmaSeq;
+    Transfer(1U);
+    Expect(h, "wrap", seq);
+  }
+
+  /* Restart after one-shot deadlines, again not aligned */
+  Sensor_StreamStop(h, SENSOR_TYPE_ACC);
+  TimerOverflow(5U);
+  Start(h);
+
+  seq = DmaSeq;
+  Transfer(3U);
+  Expect(h, "restart", seq);
+  Expect(h, "restart", seq + 1U);
+  Expect(h, "restart", seq + 2U);
+  ExpectEmpty(h, "restart");
+
+  /* Overrun skips to the oldest block not being overwritten */
+  seq = DmaSeq;
+  Transfer(TEST_BLOCK_NUM + 2U);
+  Expect(h, "overrun", seq + 3U);
+  Expect(h, "overrun", seq + 4U);
+  Expect(h, "overrun", seq + 5U);
+  ExpectEmpty(h, "overrun");
+
+  Sensor_StreamStop(h, SENSOR_TYPE_ACC);
+
+  if (failures != 0U) {
+    printf("%u failures\n", failures);
+    return (1);
+  }
+
+  printf("PASS\n");
+  return (0);
+}
@@ -25,15 +25,21 @@
 #include CMSIS_device_header
 
 #include "sensor_drv.h"
+#include "sensor_convert.h"
 
 #define SENSOR_EVENT_TOUT 5000
 
+/* Maximum number of samples read from sensor FIFO at once */
+#define SENSOR_READ_MAX   8
+
 #define SENSOR_EVENTS    (SENSOR_EVENT_TEMP_DATA_AVAILABLE  | \
                           SENSOR_EVENT_HUM_DATA_AVAILABLE   | \
                           SENSOR_EVENT_PRESS_DATA_AVAILABLE | \
                           SENSOR_EVENT_ACC_DATA_AVAILABLE   | \
                           SENSOR_EVENT_GYRO_DATA_AVAILABLE  | \
-                          SENSOR_EVENT_MAG_DATA_AVAILABLE)
+                          SENSOR_EVENT_MAG_DATA_AVAILABLE   | \
+                          SENSOR_EVENT_TEMP_OVERRUN         | \
+                          SENSOR_EVENT_ACC_OVERRUN)
 
 uint32_t Interval[6];
 int32_t  Scale[6];
@@ -43,38 +49,62 @@ int32_t Scale_Acc;
 
 osThreadId_t Th_Read;
 
+/* Sensor interface (VSI peripheral instance 0) */
+Sensor_Handle_t hSensor;
+
 void sensor_init   (void);
 void sensor_deinit (void);
 
-void Sensor_Event (uint32_t event) {
+/* Extend 32-bit sample timestamp (wraps every 2^32 us) to 64-bit time */
+static uint64_t ts_extend (uint64_t *time, uint32_t ts) {
+  *time += (uint32_t)(ts - (uint32_t)*time);
+  return (*time);
+}
+
+void Sensor_Event (Sensor_Handle_t h, uint32_t event) {
   /* Send event(s) to the processing thread */
   osThreadFlagsSet (Th_Read, event);
 }
 
 void read_sensors (void *arg) {
   uint32_t event;
-  uint32_t ts;
-  float fTemp;
-  float fAxes[3];
+  uint32_t ts[SENSOR_READ_MAX];
+  uint64_t tTemp = 0U;
+  uint64_t tAcc  = 0U;
+  int32_t num;
+  int32_t i;
+  float fTemp[SENSOR_READ_MAX];
+  float fAxes[SENSOR_READ_MAX * 3];
 
   while (1U) {
     /* Wait until Sensor callback wake-up */
     event = osThreadFlagsWait (SENSOR_EVENTS, osFlagsWaitAny, SENSOR_EVENT_TOUT);
 
     if ((event & osFlagsError) == 0U) {
-      /* Create a timestamp */
-      ts = osKernelGetTickCount();
+      if (event & SENSOR_EVENT_TEMP_OVERRUN) {
+        printf ("Temperature FIFO overrun: %d samples lost\n", Sensor_GetOverruns (hSensor, SENSOR_TYPE_TEMP));
+      }
 
-      if (event & SENSOR_EVENT_TEMP_DATA_AVAILABLE) {
-        Sensor_EnvReadData (SENSOR_TYPE_TEMP, &fTemp);
+      if (event & SENSOR_EVENT_ACC_OVERRUN) {
+        printf ("Accelerometer FIFO overrun: %d samples lost\n", Sensor_GetOverruns (hSensor, SENSOR_TYPE_ACC));
+      }
 
-        printf ("(%d ms) Temperature: %.1f\n", ts, fTemp);
+      if (event & SENSOR_EVENT_TEMP_DATA_AVAILABLE) {
+        /* Drain temperature FIFO */
+        while ((num = Sensor_ReadSamplesTs (hSensor, SENSOR_TYPE_TEMP, ts, fTemp, SENSOR_READ_MAX)) > 0) {
+          for (i = 0; i < num; i++) {
+            printf ("(%llu us) Temperature: %.1f\n", (unsigned long long)ts_extend(&tTemp, ts[i]), fTemp[i]);
+          }
+        }
       }
 
       if (event & SENSOR_EVENT_ACC_DATA_AVAILABLE) {
-        Sensor_MotionReadData (SENSOR_TYPE_ACC, &fAxes[0], &fAxes[1], &fAxes[2]);
-
-        printf ("(%d ms) Acceleration: %.5f, %.5f, %.5f\n", ts, fAxes[0], fAxes[1], fAxes[2]);
+        /* Drain accelerometer FIFO */
+        while ((num = Sensor_ReadSamplesTs (hSensor, SENSOR_TYPE_ACC, ts, fAxes, SENSOR_READ_MAX * 3)) > 0) {
+          for (i = 0; i < num; i += 3) {
+            printf ("(%llu us) Acceleration: %.5f, %.5f, %.5f\n", (unsigned long long)ts_extend(&tAcc, ts[i/3]), fAxes[i], fAxes[i+1], fAxes[i+2]);
+          }
+        }
       }
     }
     else {
@@ -90,40 +120,82 @@ void read_sensors (void *arg) {
   }
 }
 
+#ifdef SENSOR_CONVERT_BENCHMARK
+#define BENCH_SAMPLES    256
+
+static int32_t BenchRaw[BENCH_SAMPLES * 3];
+static float   BenchX[BENCH_SAMPLES];
+static float   BenchY[BENCH_SAMPLES];
+static float   BenchZ[BENCH_SAMPLES];
+
+/* Compare scalar per-entry conversion loop with block conversion kernel (used by Sensor_ReadSamples) */
+static void convert_benchmark (void) {
+  uint32_t i;
+  uint32_t t0, t1, t2;
+  int32_t scale = 100000;
+
+  for (i = 0U; i < (BENCH_SAMPLES * 3); i++) {
+    BenchRaw[i] = (int32_t)(i * 1234U) - 500000;
+  }
+
+  t0 = osKernelGetSysTimerCount();
+
+  for (i = 0U; i < BENCH_SAMPLES; i++) {
+    BenchX[i] = (float)BenchRaw[(3 * i) + 0] / scale;
+    BenchY[i] = (float)BenchRaw[(3 * i) + 1] / scale;
+    BenchZ[i] = (float)BenchRaw[(3 * i) + 2] / scale;
+  }
+
+  t1 = osKernelGetSysTimerCount();
+
+  Sensor_ConvertAxes (BenchRaw, BenchX, BenchY, BenchZ, BENCH_SAMPLES, scale);
+
+  t2 = osKernelGetSysTimerCount();
+
+  printf ("Conversion of %d samples: per-sample %u, block %u timer ticks\n", BENCH_SAMPLES, t1 - t0, t2 - t1);
+}
+#endif
+
 void sensor_init (void) {
   uint32_t interval;
   int32_t scale;
 
-  Sensor_Initialize (Sensor_Event);
+  hSensor = Sensor_GetHandle (0U);
 
-  Sensor_QueryInterval (SENSOR_TYPE_TEMP, &Interval[SENSOR_TYPE_TEMP], 1U);
-  Sensor_QueryInterval (SENSOR_TYPE_ACC,  &Interval[SENSOR_TYPE_ACC],  1U);
+  Sensor_Initialize (hSensor, Sensor_Event);
 
-  Sensor_Enable (SENSOR_TYPE_TEMP);
-  Sensor_Enable (SENSOR_TYPE_ACC);
+  Sensor_QueryInterval (hSensor, SENSOR_TYPE_TEMP, &Interval[SENSOR_TYPE_TEMP], 1U);
+  Sensor_QueryInterval (hSensor, SENSOR_TYPE_ACC,  &Interval[SENSOR_TYPE_ACC],  1U);
 
-  Sensor_QueryScale    (SENSOR_TYPE_TEMP, &Scale[SENSOR_TYPE_TEMP], 1U);
-  Sensor_QueryScale    (SENSOR_TYPE_ACC,  &Scale[SENSOR_TYPE_ACC],  1U);
+  /* Coalesce accelerometer events, but deliver data at least once per second */
+  Sensor_SetWatermark (hSensor, SENSOR_TYPE_ACC, 4U);
+  Sensor_SetLatency   (hSensor, 1000000U);
 
-  //Sensor_SetScale (SENSOR_TYPE_TEMP, Scale[SENSOR_TYPE_TEMP]);
-  //Sensor_SetScale (SENSOR_TYPE_ACC,  Scale[SENSOR_TYPE_ACC]);
+  Sensor_Enable (hSensor, SENSOR_TYPE_TEMP);
+  Sensor_Enable (hSensor, SENSOR_TYPE_ACC);
 
-  scale    = Sensor_GetScale   (SENSOR_TYPE_TEMP);
-  interval = Sensor_GetInterval(SENSOR_TYPE_TEMP);
+  Sensor_QueryScale    (hSensor, SENSOR_TYPE_TEMP, &Scale[SENSOR_TYPE_TEMP], 1U);
+  Sensor_QueryScale    (hSensor, SENSOR_TYPE_ACC,  &Scale[SENSOR_TYPE_ACC],  1U);
+
+  //Sensor_SetScale (hSensor, SENSOR_TYPE_TEMP, Scale[SENSOR_TYPE_TEMP]);
+  //Sensor_SetScale (hSensor, SENSOR_TYPE_ACC,  Scale[SENSOR_TYPE_ACC]);
+
+  scale    = Sensor_GetScale   (hSensor, SENSOR_TYPE_TEMP);
+  interval = Sensor_GetInterval(hSensor, SENSOR_TYPE_TEMP);
   printf ("Temperature: scale=%i, interval=%d\n", scale, interval);
 
-  scale    = Sensor_GetScale   (SENSOR_TYPE_ACC);
-  interval = Sensor_GetInterval(SENSOR_TYPE_ACC);
+  scale    = Sensor_GetScale   (hSensor, SENSOR_TYPE_ACC);
+  interval = Sensor_GetInterval(hSensor, SENSOR_TYPE_ACC);
   printf ("Acceleration: scale=%i, interval=%d\n", scale, interval);
   printf ("\n\n");
 }
 
 void sensor_deinit (void) {
 
-  Sensor_Disable (SENSOR_TYPE_TEMP);
-  Sensor_Disable (SENSOR_TYPE_ACC);
+  Sensor_Disable (hSensor, SENSOR_TYPE_TEMP);
+  Sensor_Disable (hSensor, SENSOR_TYPE_ACC);
 
-  Sensor_Uninitialize();
+  Sensor_Uninitialize(hSensor);
 }
 
 /*---------------------------------------------------------------------------
@@ -132,6 +204,10 @@ void sensor_deinit (void) {
 static void app_main (void *argument) {
   osThreadAttr_t attr;
 
+#ifdef SENSOR_CONVERT_BENCHMARK
+  convert_benchmark();
+#endif
+
   /* Initialize sensor interface */
   sensor_init();
 